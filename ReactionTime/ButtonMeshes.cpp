@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "ButtonMeshes.h"
+#include "Buttons.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+static_assert(GameTags::button_max <= 32, "switchedOn has a bit per button tag");
+
+namespace
+{
+	StaticMesh staticMesh(size_t first, size_t end)
+	{
+		StaticMesh mesh = { D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, static_cast<unsigned int>(first), static_cast<unsigned int>(end - first) };
+		return mesh;
+	}
+
+	// the two triangles PrimitiveBatch::DrawQuad() makes of the button's corners
+	void appendButton(std::vector<VertexPositionColor>& vertices, const ButtonLayout& button, FXMVECTOR color)
+	{
+		const int quad[6] = { 0, 1, 2, 0, 2, 3 };
+		for (int i : quad)
+			vertices.push_back(VertexPositionColor(Vector2(button.corner[i].x, button.corner[i].y), color));
+	}
+}
+
+void ButtonMeshes::Append(std::vector<VertexPositionColor>& vertices, FXMVECTOR color, FXMVECTOR highlightColor)
+{
+	for (int state = 0; state < GameTags::state_max; state++)
+	{
+		const size_t first = vertices.size();
+		for (const ButtonLayout& button : Buttons)
+		{
+			if (button.screens & ScreenBit(static_cast<GameTags::GameState>(state)))
+				appendButton(vertices, button, color);
+		}
+		screens[state] = staticMesh(first, vertices.size());
+	}
+	for (const ButtonLayout& button : Buttons)
+	{
+		const size_t first = vertices.size();
+		if (button.screens)
+			appendButton(vertices, button, highlightColor);
+		highlights[button.tag] = staticMesh(first, vertices.size());
+	}
+}
+
+void ButtonMeshes::Record(DrawList& drawList, GameTags::GameState state, GameTags::ButtonTag hovered, unsigned int switchedOn,
+	FXMVECTOR labelColor) const
+{
+	drawList.AddStatic(screens[state]);
+	for (const ButtonLayout& button : Buttons)
+	{
+		if (!(button.screens & ScreenBit(state)))
+			continue;
+		const bool highlight = button.toggle ? (switchedOn & (1u << button.tag)) != 0 : button.tag == hovered;
+		if (highlight)
+			drawList.AddStatic(highlights[button.tag]);
+	}
+	for (const ButtonLayout& button : Buttons)
+	{
+		if (button.labelled & ScreenBit(state))
+			drawList.AddText(button.label, button.corner[0].x + button.labelX, button.corner[0].y + button.labelY, labelColor, 0.0f,
+				button.labelScale, labelOrigins[button.tag]);
+	}
+}
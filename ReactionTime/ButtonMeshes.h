@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include "GameTags.h"
+#include "DrawList.h"
+
+// The buttons as static geometry: every button of a screen in one mesh, and each button
+// alone in the highlight colour to draw on top of it
+struct ButtonMeshes
+{
+	// appends the meshes to the static vertices and points the ranges below at them
+	void Append(std::vector<DirectX::VertexPositionColor>& vertices, DirectX::FXMVECTOR color, DirectX::FXMVECTOR highlightColor);
+	// every button of the screen, highlighted where hovered or switched on, then their labels on top.
+	// switchedOn has a bit per ButtonTag, only toggle buttons look at it.
+	void Record(DrawList& drawList, GameTags::GameState state, GameTags::ButtonTag hovered, unsigned int switchedOn,
+		DirectX::FXMVECTOR labelColor) const;
+
+	StaticMesh screens[GameTags::state_max] = {};
+	StaticMesh highlights[GameTags::button_max] = {};
+	// half the measured label size, filled in by whoever has the font
+	DirectX::XMFLOAT2 labelOrigins[GameTags::button_max] = {};
+};
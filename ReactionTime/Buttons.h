@@ -1,141 +1,129 @@
 #pragma once
 
-using namespace DirectX::SimpleMath;
+#include "GameTags.h"
 
-#define MAX_BUTTONS 13
-
-// Define button
-// Add button to array
-// Define button tag
-// Add functionality in Render()
+// Adding a button:
+// Add a button tag in GameTags.h, right before button_max
+// Add its entry below, at the same position as its tag
 // Add functionality in Main()
 
-const static Vector2 OptionsButton[] =
-{
-	{ 280.0f + 50.0f, 330.0f - 65.0f },
-	{ 280.0f + 150.0f, 330.0f },
-	{ 280.0f - 120.0f, 330.0f },
-	{ 280.0f - 120.0f, 330.0f - 65.0f }
-};
-
-const static Vector2 StartButton[] =
-{
-	{ 590.0f, 330.0f - 65.0f },
-	{ 590.0f, 330.0f },
-	{ 590.0f - 150.0f, 330.0f },
-	{ 590.0f - 250.0f, 330.0f - 65.0f }
-};
+// Corners go clockwise starting at the top right, like the quads PrimitiveBatch draws
+struct ButtonCorner { float x; float y; };
 
-const static Vector2 CrazyButton[] =
+enum ButtonKind
 {
-	{ 720.0f + 120.0f, 330.0f - 65.0f },
-	{ 720.0f + 120.0f, 330.0f },
-	{ 720.0f - 120.0f, 330.0f },
-	{ 720.0f - 120.0f, 330.0f - 65.0f }
+	// axis aligned, the bounding box is the exact hit area
+	button_box,
+	// anything else, hits inside the bounding box still need the edge test
+	button_quad
 };
 
-const static Vector2 SoundButton[] =
+struct ButtonLayout
 {
-	{ 10.0f + 10.0f, 20.0f - 20.0f },
-	{ 10.0f + 10.0f, 20.0f },
-	{ 10.0f - 10.0f, 20.0f },
-	{ 10.0f - 10.0f, 20.0f - 20.0f }
+	GameTags::ButtonTag tag;
+	ButtonCorner corner[4];
+	// bit per game state (ScreenBit) the button is drawn on, and the ones it gets its label on
+	unsigned int screens;
+	unsigned int labelled;
+	// label position relative to corner[0]
+	const wchar_t* label;
+	float labelX;
+	float labelY;
+	float labelScale;
+	// coloured by its option instead of by hovering
+	bool toggle;
+	// filled in by MakeButton()
+	float left;
+	float top;
+	float right;
+	float bottom;
+	ButtonKind kind;
 };
 
-const static Vector2 ShapeSizeUpButton[] =
+constexpr unsigned int ScreenBit(GameTags::GameState state)
 {
-	{ 500.0f + 10.0f, 400.0f - 20.0f },
-	{ 500.0f + 10.0f, 400.0f },
-	{ 500.0f - 10.0f, 400.0f },
-	{ 500.0f - 10.0f, 400.0f - 20.0f }
-};
+	return 1u << state;
+}
 
-const static Vector2 ShapeSizeDownButton[] =
+constexpr float Min4(float a, float b, float c, float d)
 {
-	{ 550.0f + 10.0f, 400.0f - 20.0f },
-	{ 550.0f + 10.0f, 400.0f },
-	{ 550.0f - 10.0f, 400.0f },
-	{ 550.0f - 10.0f, 400.0f - 20.0f }
-};
+	return (a < b ? a : b) < (c < d ? c : d) ? (a < b ? a : b) : (c < d ? c : d);
+}
 
-const static Vector2 GameTimeUpButton[] =
+constexpr float Max4(float a, float b, float c, float d)
 {
-	{ 500.0f + 10.0f, 360.0f - 20.0f },
-	{ 500.0f + 10.0f, 360.0f },
-	{ 500.0f - 10.0f, 360.0f },
-	{ 500.0f - 10.0f, 360.0f - 20.0f }
-};
+	return (a > b ? a : b) > (c > d ? c : d) ? (a > b ? a : b) : (c > d ? c : d);
+}
 
-const static Vector2 GameTimeDownButton[] =
+constexpr ButtonKind Classify(ButtonCorner c0, ButtonCorner c1, ButtonCorner c2, ButtonCorner c3)
 {
-	{ 550.0f + 10.0f, 360.0f - 20.0f },
-	{ 550.0f + 10.0f, 360.0f },
-	{ 550.0f - 10.0f, 360.0f },
-	{ 550.0f - 10.0f, 360.0f - 20.0f }
-};
+	return (c0.x == c1.x && c2.x == c3.x && c1.y == c2.y && c3.y == c0.y) ||
+		(c0.y == c1.y && c2.y == c3.y && c1.x == c2.x && c3.x == c0.x) ? button_box : button_quad;
+}
 
-const static Vector2 EditorButton[] =
+constexpr ButtonLayout MakeButton(GameTags::ButtonTag tag, ButtonCorner c0, ButtonCorner c1, ButtonCorner c2, ButtonCorner c3,
+	unsigned int screens, unsigned int labelled, const wchar_t* label, float labelX, float labelY, float labelScale, bool toggle)
 {
-	{ 720.0f + 120.0f, 405.0f - 65.0f },
-	{ 720.0f + 120.0f, 405.0f },
-	{ 720.0f - 120.0f, 405.0f },
-	{ 720.0f - 120.0f, 405.0f - 65.0f }
-};
+	return ButtonLayout{ tag, { c0, c1, c2, c3 }, screens, labelled, label, labelX, labelY, labelScale, toggle,
+		Min4(c0.x, c1.x, c2.x, c3.x), Min4(c0.y, c1.y, c2.y, c3.y), Max4(c0.x, c1.x, c2.x, c3.x), Max4(c0.y, c1.y, c2.y, c3.y),
+		Classify(c0, c1, c2, c3) };
+}
 
-const static Vector2 UseOwnShapeButton[] =
-{
-	{ 720.0f + 120.0f, 405.0f - 65.0f },
-	{ 720.0f + 120.0f, 405.0f },
-	{ 720.0f - 120.0f, 405.0f },
-	{ 720.0f - 120.0f, 405.0f - 65.0f }
-};
+#define SCREEN_START ScreenBit(GameTags::state_startmenu)
+#define SCREEN_OPTIONS ScreenBit(GameTags::state_optionsmenu)
+#define SCREEN_END ScreenBit(GameTags::state_endmenu)
+#define SCREEN_EDITOR ScreenBit(GameTags::state_editor)
 
-const static Vector2 UseGravityButton[] =
+constexpr ButtonLayout Buttons[] =
 {
-	{ 720.0f + 120.0f, 480.0f - 65.0f },
-	{ 720.0f + 120.0f, 480.0f },
-	{ 720.0f - 120.0f, 480.0f },
-	{ 720.0f - 120.0f, 480.0f - 65.0f }
+	MakeButton(GameTags::button_null, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f },
+		0, 0, nullptr, 0.0f, 0.0f, 0.0f, false),
+	MakeButton(GameTags::button_options,
+		{ 280.0f + 50.0f, 330.0f - 65.0f }, { 280.0f + 150.0f, 330.0f }, { 280.0f - 120.0f, 330.0f }, { 280.0f - 120.0f, 330.0f - 65.0f },
+		SCREEN_START | SCREEN_END, SCREEN_START | SCREEN_END, L"Options", -70.0f, 35.0f, 1.0f, false),
+	MakeButton(GameTags::button_start,
+		{ 590.0f, 330.0f - 65.0f }, { 590.0f, 330.0f }, { 590.0f - 150.0f, 330.0f }, { 590.0f - 250.0f, 330.0f - 65.0f },
+		SCREEN_START | SCREEN_OPTIONS | SCREEN_END, SCREEN_START | SCREEN_END, L"Start", -90.0f, 35.0f, 1.0f, false),
+	MakeButton(GameTags::button_crazy,
+		{ 720.0f + 120.0f, 330.0f - 65.0f }, { 720.0f + 120.0f, 330.0f }, { 720.0f - 120.0f, 330.0f }, { 720.0f - 120.0f, 330.0f - 65.0f },
+		SCREEN_START | SCREEN_OPTIONS | SCREEN_END, SCREEN_START | SCREEN_END, L"Crazy", -150.0f, 35.0f, 1.0f, false),
+	MakeButton(GameTags::button_sound,
+		{ 10.0f + 10.0f, 20.0f - 20.0f }, { 10.0f + 10.0f, 20.0f }, { 10.0f - 10.0f, 20.0f }, { 10.0f - 10.0f, 20.0f - 20.0f },
+		SCREEN_START | SCREEN_OPTIONS, 0, nullptr, 0.0f, 0.0f, 0.0f, false),
+	MakeButton(GameTags::button_shapeSizeUp,
+		{ 500.0f + 10.0f, 400.0f - 20.0f }, { 500.0f + 10.0f, 400.0f }, { 500.0f - 10.0f, 400.0f }, { 500.0f - 10.0f, 400.0f - 20.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"+", -13.0f, 11.0f, 0.7f, false),
+	MakeButton(GameTags::button_shapeSizeDown,
+		{ 550.0f + 10.0f, 400.0f - 20.0f }, { 550.0f + 10.0f, 400.0f }, { 550.0f - 10.0f, 400.0f }, { 550.0f - 10.0f, 400.0f - 20.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"-", -13.0f, 11.0f, 0.7f, false),
+	MakeButton(GameTags::button_gameTimeUp,
+		{ 500.0f + 10.0f, 360.0f - 20.0f }, { 500.0f + 10.0f, 360.0f }, { 500.0f - 10.0f, 360.0f }, { 500.0f - 10.0f, 360.0f - 20.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"+", -13.0f, 11.0f, 0.7f, false),
+	MakeButton(GameTags::button_gameTimeDown,
+		{ 550.0f + 10.0f, 360.0f - 20.0f }, { 550.0f + 10.0f, 360.0f }, { 550.0f - 10.0f, 360.0f }, { 550.0f - 10.0f, 360.0f - 20.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"-", -13.0f, 11.0f, 0.7f, false),
+	MakeButton(GameTags::button_editor,
+		{ 720.0f + 120.0f, 405.0f - 65.0f }, { 720.0f + 120.0f, 405.0f }, { 720.0f - 120.0f, 405.0f }, { 720.0f - 120.0f, 405.0f - 65.0f },
+		SCREEN_START | SCREEN_END, SCREEN_START | SCREEN_END, L"Editor", -150.0f, 35.0f, 1.0f, false),
+	MakeButton(GameTags::button_useOwnShape,
+		{ 720.0f + 120.0f, 405.0f - 65.0f }, { 720.0f + 120.0f, 405.0f }, { 720.0f - 120.0f, 405.0f }, { 720.0f - 120.0f, 405.0f - 65.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"Use own shape", -70.0f, 35.0f, 1.0f, true),
+	MakeButton(GameTags::button_useGravity,
+		{ 720.0f + 120.0f, 480.0f - 65.0f }, { 720.0f + 120.0f, 480.0f }, { 720.0f - 120.0f, 480.0f }, { 720.0f - 120.0f, 480.0f - 65.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"Use gravity", -70.0f, 35.0f, 1.0f, true),
+	MakeButton(GameTags::button_epileptic,
+		{ 280.0f + 120.0f, 405.0f - 65.0f }, { 280.0f + 120.0f, 405.0f }, { 280.0f - 120.0f, 405.0f }, { 280.0f - 120.0f, 405.0f - 65.0f },
+		SCREEN_OPTIONS, SCREEN_OPTIONS, L"Epileptic", -70.0f, 35.0f, 1.0f, true),
+	// same spot as options, leads back out of the options menu and the editor
+	MakeButton(GameTags::button_back,
+		{ 280.0f + 50.0f, 330.0f - 65.0f }, { 280.0f + 150.0f, 330.0f }, { 280.0f - 120.0f, 330.0f }, { 280.0f - 120.0f, 330.0f - 65.0f },
+		SCREEN_OPTIONS | SCREEN_EDITOR, SCREEN_OPTIONS | SCREEN_EDITOR, L"Back", -70.0f, 35.0f, 1.0f, false),
 };
 
-const static Vector2 EpilepticModeButton[] =
+constexpr bool ButtonsInTagOrder(int i)
 {
-	{ 280.0f + 120.0f, 405.0f - 65.0f },
-	{ 280.0f + 120.0f, 405.0f },
-	{ 280.0f - 120.0f, 405.0f },
-	{ 280.0f - 120.0f, 405.0f - 65.0f }
-};
+	return i == GameTags::button_max || (Buttons[i].tag == i && ButtonsInTagOrder(i + 1));
+}
 
-/*
-0 = Null
-1 = OptionsButton
-2 = startButton
-3 = CrazyButton
-4 = SoundButton
-5 = ShapeSizeUpButton
-6 = ShapeSizeDownButton
-7 = GameTimeUpButton
-8 = GameTimeDown
-9 = EditorButton
-10 = UseOwnShapeButton
-11 = UseGravityButton
-12 = EpilepticModeButton
-13 = Max
-*/
-
-const static Vector2 ButtonArray[MAX_BUTTONS][4] =
-{
-	{ Vector2(NULL, NULL), Vector2(NULL, NULL), Vector2(NULL, NULL), Vector2(NULL, NULL) },
-	{ OptionsButton[0], OptionsButton[1], OptionsButton[2], OptionsButton[3] },
-	{ StartButton[0], StartButton[1], StartButton[2], StartButton[3] },
-	{ CrazyButton[0], CrazyButton[1], CrazyButton[2], CrazyButton[3] },
-	{ SoundButton[0], SoundButton[1], SoundButton[2], SoundButton[3] },
-	{ ShapeSizeUpButton[0], ShapeSizeUpButton[1], ShapeSizeUpButton[2], ShapeSizeUpButton[3] },
-	{ ShapeSizeDownButton[0], ShapeSizeDownButton[1], ShapeSizeDownButton[2], ShapeSizeDownButton[3] },
-	{ GameTimeUpButton[0], GameTimeUpButton[1], GameTimeUpButton[2], GameTimeUpButton[3] },
-	{ GameTimeDownButton[0], GameTimeDownButton[1], GameTimeDownButton[2], GameTimeDownButton[3] },
-	{ EditorButton[0], EditorButton[1], EditorButton[2], EditorButton[3] },
-	{ UseOwnShapeButton[0], UseOwnShapeButton[1], UseOwnShapeButton[2], UseOwnShapeButton[3] },
-	{ UseGravityButton[0], UseGravityButton[1], UseGravityButton[2], UseGravityButton[3] },
-	{ EpilepticModeButton[0], EpilepticModeButton[1], EpilepticModeButton[2], EpilepticModeButton[3] },
-};
\ No newline at end of file
+static_assert(sizeof(Buttons) / sizeof(Buttons[0]) == GameTags::button_max, "one entry per button tag");
+static_assert(ButtonsInTagOrder(0), "button entries have to follow the order of their tags");
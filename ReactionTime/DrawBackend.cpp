@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "DrawBackend.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+D3DDrawBackend::D3DDrawBackend(ID3D11Device* device, ID3D11DeviceContext* context, BasicEffect* effect, ID3D11InputLayout* inputLayout,
+	PrimitiveBatch<VertexPositionColor>* batch, SpriteBatch* spriteBatch, SpriteFont* font)
+	: device(device), context(context), effect(effect), inputLayout(inputLayout), batch(batch), spriteBatch(spriteBatch), font(font)
+{
+}
+
+void D3DDrawBackend::SetStaticVertices(const VertexPositionColor* vertices, size_t vertexCount)
+{
+	staticVertices.Reset();
+	if (vertexCount == 0)
+		return;
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.ByteWidth = static_cast<UINT>(vertexCount * sizeof(VertexPositionColor));
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	D3D11_SUBRESOURCE_DATA data = {};
+	data.pSysMem = vertices;
+	DX::ThrowIfFailed(device->CreateBuffer(&desc, &data, staticVertices.ReleaseAndGetAddressOf()));
+}
+
+void D3DDrawBackend::BeginPrimitives()
+{
+	effect->Apply(context);
+	context->IASetInputLayout(inputLayout);
+}
+
+void D3DDrawBackend::DrawPrimitives(D3D11_PRIMITIVE_TOPOLOGY topology, const uint16_t* indices, size_t indexCount,
+	const VertexPositionColor* vertices, size_t vertexCount)
+{
+	if (!batchOpen)
+	{
+		batch->Begin();
+		batchOpen = true;
+	}
+	batch->DrawIndexed(topology, indices, indexCount, vertices, vertexCount);
+}
+
+void D3DDrawBackend::DrawStatic(const StaticMesh& mesh)
+{
+	// whatever the batch queued has to be drawn first, it sits underneath
+	if (batchOpen)
+	{
+		batch->End();
+		batchOpen = false;
+	}
+
+	ID3D11Buffer* buffer = staticVertices.Get();
+	const UINT stride = sizeof(VertexPositionColor);
+	const UINT offset = 0;
+	context->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+	context->IASetPrimitiveTopology(mesh.topology);
+	context->Draw(mesh.vertexCount, mesh.firstVertex);
+}
+
+void D3DDrawBackend::SetTransform(const XMFLOAT4X4& world, FXMVECTOR tint)
+{
+	// the batch's queued vertices belong to the previous transform
+	if (batchOpen)
+	{
+		batch->End();
+		batchOpen = false;
+	}
+
+	// vertex colours get multiplied by the diffuse colour
+	effect->SetWorld(XMLoadFloat4x4(&world));
+	effect->SetDiffuseColor(tint);
+	effect->SetAlpha(XMVectorGetW(tint));
+	effect->Apply(context);
+}
+
+void D3DDrawBackend::EndPrimitives()
+{
+	if (batchOpen)
+	{
+		batch->End();
+		batchOpen = false;
+	}
+}
+
+void D3DDrawBackend::BeginText()
+{
+	spriteBatch->Begin();
+}
+
+void D3DDrawBackend::DrawString(const wchar_t* text, XMFLOAT2 position, FXMVECTOR color, float rotation, XMFLOAT2 origin, float scale)
+{
+	font->DrawString(spriteBatch, text, position, color, rotation, origin, scale);
+}
+
+void D3DDrawBackend::EndText()
+{
+	spriteBatch->End();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Range of the static vertices, geometry that looks the same every frame
+struct StaticMesh
+{
+	D3D11_PRIMITIVE_TOPOLOGY topology;
+	unsigned int firstVertex;
+	unsigned int vertexCount;
+};
+
+// Where a DrawList ends up. Each pass binds its pipeline state once in Begin...()
+// and keeps it until End...(), so passes are what costs state changes.
+class DrawBackend
+{
+public:
+	virtual ~DrawBackend() { }
+	// uploads the vertices every StaticMesh points into, once per device
+	virtual void SetStaticVertices(const DirectX::VertexPositionColor* vertices, size_t vertexCount) = 0;
+	virtual void BeginPrimitives() = 0;
+	virtual void DrawPrimitives(D3D11_PRIMITIVE_TOPOLOGY topology, const uint16_t* indices, size_t indexCount,
+		const DirectX::VertexPositionColor* vertices, size_t vertexCount) = 0;
+	virtual void DrawStatic(const StaticMesh& mesh) = 0;
+	// moves and tints the vertices of the draws that follow, until it is set back to identity and white
+	virtual void SetTransform(const DirectX::XMFLOAT4X4& world, DirectX::FXMVECTOR tint) = 0;
+	virtual void EndPrimitives() = 0;
+	virtual void BeginText() = 0;
+	// origin is measured by the caller, who can keep it as long as the text doesn't change
+	virtual void DrawString(const wchar_t* text, DirectX::XMFLOAT2 position, DirectX::FXMVECTOR color, float rotation, DirectX::XMFLOAT2 origin, float scale) = 0;
+	virtual void EndText() = 0;
+};
+
+#ifdef _WIN32
+// Draws through the effect, PrimitiveBatch and SpriteBatch the game created,
+// static meshes straight from an immutable vertex buffer
+class D3DDrawBackend : public DrawBackend
+{
+public:
+	D3DDrawBackend(ID3D11Device* device, ID3D11DeviceContext* context, DirectX::BasicEffect* effect, ID3D11InputLayout* inputLayout,
+		DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* batch, DirectX::SpriteBatch* spriteBatch, DirectX::SpriteFont* font);
+	void SetStaticVertices(const DirectX::VertexPositionColor* vertices, size_t vertexCount) override;
+	void BeginPrimitives() override;
+	void DrawPrimitives(D3D11_PRIMITIVE_TOPOLOGY topology, const uint16_t* indices, size_t indexCount,
+		const DirectX::VertexPositionColor* vertices, size_t vertexCount) override;
+	void DrawStatic(const StaticMesh& mesh) override;
+	void SetTransform(const DirectX::XMFLOAT4X4& world, DirectX::FXMVECTOR tint) override;
+	void EndPrimitives() override;
+	void BeginText() override;
+	void DrawString(const wchar_t* text, DirectX::XMFLOAT2 position, DirectX::FXMVECTOR color, float rotation, DirectX::XMFLOAT2 origin, float scale) override;
+	void EndText() override;
+
+private:
+	ID3D11Device* device;
+	ID3D11DeviceContext* context;
+	DirectX::BasicEffect* effect;
+	ID3D11InputLayout* inputLayout;
+	DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* batch;
+	DirectX::SpriteBatch* spriteBatch;
+	DirectX::SpriteFont* font;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> staticVertices;
+	// the batch binds its own buffers in Begin(), it is only open while it has something to draw
+	bool batchOpen = false;
+};
+#endif
+
+// Draws nothing, only counts what a frame would cost. Runs without a device,
+// so batching can be checked headless.
+class CountingDrawBackend : public DrawBackend
+{
+public:
+	void Reset() { passes = stateChanges = drawCalls = primitives = strings = 0; }
+	void SetStaticVertices(const DirectX::VertexPositionColor*, size_t vertexCount) override { staticVertices = vertexCount; }
+	void BeginPrimitives() override { passes++; stateChanges++; topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED; dynamic = false; }
+	void DrawPrimitives(D3D11_PRIMITIVE_TOPOLOGY topology, const uint16_t*, size_t indexCount,
+		const DirectX::VertexPositionColor*, size_t) override
+	{
+		// switching between the batch's buffers and the static one rebinds the vertex buffer
+		if (topology != this->topology || !dynamic)
+			stateChanges++;
+		this->topology = topology;
+		dynamic = true;
+		drawCalls++;
+		primitives += topology == D3D11_PRIMITIVE_TOPOLOGY_LINELIST ? indexCount / 2 : indexCount / 3;
+	}
+	void DrawStatic(const StaticMesh& mesh) override
+	{
+		if (mesh.topology != topology || dynamic)
+			stateChanges++;
+		topology = mesh.topology;
+		dynamic = false;
+		drawCalls++;
+		primitives += mesh.topology == D3D11_PRIMITIVE_TOPOLOGY_LINELIST ? mesh.vertexCount / 2 : mesh.vertexCount / 3;
+	}
+	// new constants for the effect, and the next draw binds its buffers and topology again
+	void SetTransform(const DirectX::XMFLOAT4X4&, DirectX::FXMVECTOR) override { stateChanges++; topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED; }
+	void EndPrimitives() override { }
+	// the whole pass shares the font texture, SpriteBatch draws it at once in End()
+	void BeginText() override { passes++; stateChanges++; }
+	void DrawString(const wchar_t*, DirectX::XMFLOAT2, DirectX::FXMVECTOR, float, DirectX::XMFLOAT2, float) override { strings++; }
+	void EndText() override { drawCalls++; }
+
+	unsigned int passes = 0;
+	unsigned int stateChanges = 0;
+	unsigned int drawCalls = 0;
+	unsigned int primitives = 0;
+	unsigned int strings = 0;
+	size_t staticVertices = 0;
+
+private:
+	D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	bool dynamic = false;
+};
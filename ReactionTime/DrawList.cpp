@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "DrawList.h"
+#include <string.h>
+
+using namespace DirectX;
+
+void DrawList::Clear()
+{
+	vertices.clear();
+	indices.clear();
+	chars.clear();
+	runs.clear();
+	transforms.clear();
+	texts.clear();
+	layers.clear();
+}
+
+DrawList::Layer& DrawList::PrimitiveLayer()
+{
+	// text is drawn over the layer's primitives, anything recorded after it needs the next layer
+	if (layers.empty() || layers.back().textCount > 0)
+	{
+		Layer layer = { runs.size(), 0, texts.size(), 0 };
+		layers.push_back(layer);
+	}
+	return layers.back();
+}
+
+uint16_t DrawList::Open(D3D11_PRIMITIVE_TOPOLOGY topology, size_t vertexCount, size_t indexCount, size_t transform)
+{
+	Layer& layer = PrimitiveLayer();
+	if (layer.runCount == 0 || runs.back().isStatic || runs.back().topology != topology || runs.back().transform != transform ||
+		runs.back().vertexCount + vertexCount > DRAW_LIST_MAX_VERTICES ||
+		runs.back().indexCount + indexCount > DRAW_LIST_MAX_INDICES)
+	{
+		Run run = { topology, vertices.size(), 0, indices.size(), 0, false, transform };
+		runs.push_back(run);
+		layer.runCount++;
+	}
+
+	Run& run = runs.back();
+	const uint16_t base = static_cast<uint16_t>(run.vertexCount);
+	run.vertexCount += vertexCount;
+	run.indexCount += indexCount;
+	return base;
+}
+
+void DrawList::AddLine(const VertexPositionColor& v1, const VertexPositionColor& v2)
+{
+	const uint16_t base = Open(D3D11_PRIMITIVE_TOPOLOGY_LINELIST, 2, 2);
+	vertices.push_back(v1);
+	vertices.push_back(v2);
+	indices.push_back(base);
+	indices.push_back(base + 1);
+}
+
+void DrawList::AddTriangle(const VertexPositionColor& v1, const VertexPositionColor& v2, const VertexPositionColor& v3)
+{
+	const uint16_t base = Open(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 3, 3);
+	vertices.push_back(v1);
+	vertices.push_back(v2);
+	vertices.push_back(v3);
+	indices.push_back(base);
+	indices.push_back(base + 1);
+	indices.push_back(base + 2);
+}
+
+void DrawList::AddQuad(const VertexPositionColor& v1, const VertexPositionColor& v2, const VertexPositionColor& v3, const VertexPositionColor& v4)
+{
+	const uint16_t base = Open(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 4, 6);
+	vertices.push_back(v1);
+	vertices.push_back(v2);
+	vertices.push_back(v3);
+	vertices.push_back(v4);
+	const uint16_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+	for (uint16_t index : quad)
+		indices.push_back(base + index);
+}
+
+void DrawList::AddIndexed(const uint16_t* indices, size_t indexCount, const VertexPositionColor* vertices, size_t vertexCount)
+{
+	AddIndexedRun(indices, indexCount, vertices, vertexCount, noTransform);
+}
+
+void DrawList::AddIndexed(const uint16_t* indices, size_t indexCount, const VertexPositionColor* vertices, size_t vertexCount,
+	const XMFLOAT4X4& world, FXMVECTOR tint)
+{
+	if (indexCount == 0)
+		return;
+	AddIndexedRun(indices, indexCount, vertices, vertexCount, AddTransform(world, tint));
+}
+
+void DrawList::AddIndexedRun(const uint16_t* indices, size_t indexCount, const VertexPositionColor* vertices, size_t vertexCount, size_t transform)
+{
+	// too big for one batch, split it into its triangles
+	if (vertexCount > DRAW_LIST_MAX_VERTICES || indexCount > DRAW_LIST_MAX_INDICES)
+	{
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const uint16_t base = Open(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 3, 3, transform);
+			for (size_t j = 0; j < 3; j++)
+			{
+				this->vertices.push_back(vertices[indices[i + j]]);
+				this->indices.push_back(static_cast<uint16_t>(base + j));
+			}
+		}
+		return;
+	}
+
+	const uint16_t base = Open(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, vertexCount, indexCount, transform);
+	this->vertices.insert(this->vertices.end(), vertices, vertices + vertexCount);
+	for (size_t i = 0; i < indexCount; i++)
+		this->indices.push_back(base + indices[i]);
+}
+
+void DrawList::AddStatic(const StaticMesh& mesh)
+{
+	AddStaticRun(mesh, noTransform);
+}
+
+void DrawList::AddStatic(const StaticMesh& mesh, const XMFLOAT4X4& world, FXMVECTOR tint)
+{
+	if (mesh.vertexCount == 0)
+		return;
+	AddStaticRun(mesh, AddTransform(world, tint));
+}
+
+void DrawList::AddStaticRun(const StaticMesh& mesh, size_t transform)
+{
+	if (mesh.vertexCount == 0)
+		return;
+
+	Layer& layer = PrimitiveLayer();
+	Run run = { mesh.topology, mesh.firstVertex, mesh.vertexCount, 0, 0, true, transform };
+	runs.push_back(run);
+	layer.runCount++;
+}
+
+size_t DrawList::AddTransform(const XMFLOAT4X4& world, FXMVECTOR tint)
+{
+	Transform transform = { world, XMFLOAT4() };
+	XMStoreFloat4(&transform.tint, tint);
+	// draws in a row with the same world and tint share it, so their runs merge and it is set once
+	if (!transforms.empty() && memcmp(&transforms.back(), &transform, sizeof(Transform)) == 0)
+		return transforms.size() - 1;
+	transforms.push_back(transform);
+	return transforms.size() - 1;
+}
+
+// noTransform goes back to drawing vertices as they are
+void DrawList::SetTransform(DrawBackend& backend, size_t transform) const
+{
+	if (transform != noTransform)
+	{
+		backend.SetTransform(transforms[transform].world, XMLoadFloat4(&transforms[transform].tint));
+		return;
+	}
+
+	static const XMFLOAT4X4 identity(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	static const XMFLOAT4 white(1.0f, 1.0f, 1.0f, 1.0f);
+	backend.SetTransform(identity, XMLoadFloat4(&white));
+}
+
+void DrawList::AddText(const wchar_t* text, float x, float y, FXMVECTOR color, float rotation, float scale, XMFLOAT2 origin)
+{
+	if (layers.empty())
+	{
+		Layer layer = { runs.size(), 0, texts.size(), 0 };
+		layers.push_back(layer);
+	}
+	layers.back().textCount++;
+
+	Text entry = { chars.size(), XMFLOAT2(x, y), XMFLOAT4(), rotation, scale, origin };
+	XMStoreFloat4(&entry.color, color);
+	texts.push_back(entry);
+	for (; *text; text++)
+		chars.push_back(*text);
+	chars.push_back(L'\0');
+}
+
+void DrawList::Submit(DrawBackend& backend)
+{
+	for (const Layer& layer : layers)
+	{
+		if (layer.runCount > 0)
+		{
+			backend.BeginPrimitives();
+			size_t transform = noTransform;
+			for (size_t i = layer.firstRun; i < layer.firstRun + layer.runCount; i++)
+			{
+				const Run& run = runs[i];
+				if (run.transform != transform)
+				{
+					transform = run.transform;
+					SetTransform(backend, transform);
+				}
+				if (run.isStatic)
+				{
+					StaticMesh mesh = { run.topology, static_cast<unsigned int>(run.firstVertex), static_cast<unsigned int>(run.vertexCount) };
+					backend.DrawStatic(mesh);
+				}
+				else
+					backend.DrawPrimitives(run.topology, &indices[run.firstIndex], run.indexCount, &vertices[run.firstVertex], run.vertexCount);
+			}
+			// the next pass starts from identity again, like this one did
+			if (transform != noTransform)
+				SetTransform(backend, noTransform);
+			backend.EndPrimitives();
+		}
+		if (layer.textCount > 0)
+		{
+			backend.BeginText();
+			for (size_t i = layer.firstText; i < layer.firstText + layer.textCount; i++)
+			{
+				const Text& text = texts[i];
+				backend.DrawString(&chars[text.first], text.position, XMLoadFloat4(&text.color), text.rotation, text.origin, text.scale);
+			}
+			backend.EndText();
+		}
+	}
+	Clear();
+}
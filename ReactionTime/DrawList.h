@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "DrawBackend.h"
+
+// what one PrimitiveBatch Begin/End can take, its default batch size
+#define DRAW_LIST_MAX_VERTICES 2048
+#define DRAW_LIST_MAX_INDICES (DRAW_LIST_MAX_VERTICES * 3)
+
+// Collects a frame's primitives and text, then submits them with as few passes as the
+// drawing order allows. Everything recorded until the first text after a primitive shares
+// a layer: one primitive pass with its shapes, then one sprite pass with its text on top.
+// Primitives of a pass stay in recorded order, their overlaps depend on it, but neighbours
+// with the same topology go out as one draw. Transformed draws keep their vertices in their
+// own space, the backend moves and tints them with the world and tint they were added with,
+// set once for neighbours that were added with the same ones.
+class DrawList
+{
+public:
+	void Clear();
+	void AddLine(const DirectX::VertexPositionColor& v1, const DirectX::VertexPositionColor& v2);
+	void AddTriangle(const DirectX::VertexPositionColor& v1, const DirectX::VertexPositionColor& v2, const DirectX::VertexPositionColor& v3);
+	// corners in PrimitiveBatch::DrawQuad() order
+	void AddQuad(const DirectX::VertexPositionColor& v1, const DirectX::VertexPositionColor& v2,
+		const DirectX::VertexPositionColor& v3, const DirectX::VertexPositionColor& v4);
+	// triangle list
+	void AddIndexed(const uint16_t* indices, size_t indexCount, const DirectX::VertexPositionColor* vertices, size_t vertexCount);
+	void AddIndexed(const uint16_t* indices, size_t indexCount, const DirectX::VertexPositionColor* vertices, size_t vertexCount,
+		const DirectX::XMFLOAT4X4& world, DirectX::FXMVECTOR tint);
+	// one draw straight from the backend's static vertices
+	void AddStatic(const StaticMesh& mesh);
+	void AddStatic(const StaticMesh& mesh, const DirectX::XMFLOAT4X4& world, DirectX::FXMVECTOR tint);
+	// origin is the point of the text that ends up at x, y, usually its centre
+	void AddText(const wchar_t* text, float x, float y, DirectX::FXMVECTOR color, float rotation, float scale, DirectX::XMFLOAT2 origin);
+	// draws everything and clears the list, the buffers keep their capacity for the next frame
+	void Submit(DrawBackend& backend);
+
+private:
+	// static runs point into the backend's static vertices and have no indices,
+	// transform is an index into transforms or noTransform
+	struct Run { D3D11_PRIMITIVE_TOPOLOGY topology; size_t firstVertex; size_t vertexCount; size_t firstIndex; size_t indexCount; bool isStatic; size_t transform; };
+	struct Transform { DirectX::XMFLOAT4X4 world; DirectX::XMFLOAT4 tint; };
+	static const size_t noTransform = static_cast<size_t>(-1);
+	struct Text { size_t first; DirectX::XMFLOAT2 position; DirectX::XMFLOAT4 color; float rotation; float scale; DirectX::XMFLOAT2 origin; };
+	struct Layer { size_t firstRun; size_t runCount; size_t firstText; size_t textCount; };
+
+	// makes room in a run of that topology, returns the run-relative index of the first new vertex
+	uint16_t Open(D3D11_PRIMITIVE_TOPOLOGY topology, size_t vertexCount, size_t indexCount, size_t transform = noTransform);
+	Layer& PrimitiveLayer();
+	size_t AddTransform(const DirectX::XMFLOAT4X4& world, DirectX::FXMVECTOR tint);
+	void AddIndexedRun(const uint16_t* indices, size_t indexCount, const DirectX::VertexPositionColor* vertices, size_t vertexCount, size_t transform);
+	void AddStaticRun(const StaticMesh& mesh, size_t transform);
+	void SetTransform(DrawBackend& backend, size_t transform) const;
+
+	std::vector<DirectX::VertexPositionColor> vertices;
+	std::vector<uint16_t> indices;
+	std::vector<wchar_t> chars;
+	std::vector<Run> runs;
+	std::vector<Transform> transforms;
+	std::vector<Text> texts;
+	std::vector<Layer> layers;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+// Stand-ins for the few Direct3D, DirectXMath and SimpleMath types the drawing and shape code
+// uses, so DrawList, ButtonMeshes, HudText, ShapeTransform, Triangulate and ShapeHitTest also
+// build for the tests and tools. pch.h only includes this where there is no Windows SDK.
+// Same layout and results as the real types, but only the members that code needs.
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum D3D11_PRIMITIVE_TOPOLOGY
+{
+	D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED = 0,
+	D3D11_PRIMITIVE_TOPOLOGY_LINELIST = 2,
+	D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4
+};
+
+namespace DirectX
+{
+	struct XMFLOAT2 { float x, y; XMFLOAT2() { } XMFLOAT2(float x, float y) : x(x), y(y) { } };
+	struct XMFLOAT3 { float x, y, z; XMFLOAT3() { } XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) { } };
+	struct XMFLOAT4 { float x, y, z, w; XMFLOAT4() { } XMFLOAT4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) { } };
+	struct XMFLOAT4X4
+	{
+		float m[4][4];
+		XMFLOAT4X4() { }
+		XMFLOAT4X4(float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13,
+			float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33)
+		{
+			const float values[16] = { m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33 };
+			for (int i = 0; i < 16; i++)
+				m[i / 4][i % 4] = values[i];
+		}
+	};
+
+	// a SIMD register in the real thing
+	struct XMVECTOR { float v[4]; };
+	typedef const XMVECTOR FXMVECTOR;
+	struct XMVECTORF32 { float f[4]; operator XMVECTOR() const { XMVECTOR r = { { f[0], f[1], f[2], f[3] } }; return r; } };
+
+	inline XMVECTOR XMLoadFloat4(const XMFLOAT4* source) { XMVECTOR r = { { source->x, source->y, source->z, source->w } }; return r; }
+	inline void XMStoreFloat4(XMFLOAT4* destination, FXMVECTOR v) { *destination = XMFLOAT4(v.v[0], v.v[1], v.v[2], v.v[3]); }
+	inline void XMStoreFloat3(XMFLOAT3* destination, FXMVECTOR v) { *destination = XMFLOAT3(v.v[0], v.v[1], v.v[2]); }
+	inline void XMStoreFloat2(XMFLOAT2* destination, FXMVECTOR v) { *destination = XMFLOAT2(v.v[0], v.v[1]); }
+
+	struct VertexPositionColor
+	{
+		XMFLOAT3 position;
+		XMFLOAT4 color;
+		VertexPositionColor() { }
+		VertexPositionColor(const XMFLOAT3& position, const XMFLOAT4& color) : position(position), color(color) { }
+		VertexPositionColor(FXMVECTOR position, FXMVECTOR color) { XMStoreFloat3(&this->position, position); XMStoreFloat4(&this->color, color); }
+	};
+
+	namespace SimpleMath
+	{
+		struct Matrix : XMFLOAT4X4
+		{
+			Matrix() : XMFLOAT4X4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f) { }
+			Matrix(float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13,
+				float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33)
+				: XMFLOAT4X4(m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33) { }
+			static Matrix CreateTranslation(float x, float y, float z)
+			{
+				return Matrix(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, z, 1.0f);
+			}
+		};
+
+		struct Vector2 : XMFLOAT2
+		{
+			Vector2() : XMFLOAT2(0.0f, 0.0f) { }
+			Vector2(float x, float y) : XMFLOAT2(x, y) { }
+			// z and w are 0, like XMLoadFloat2()
+			operator XMVECTOR() const { XMVECTOR r = { { x, y, 0.0f, 0.0f } }; return r; }
+			bool operator==(const Vector2& v) const { return x == v.x && y == v.y; }
+			bool operator!=(const Vector2& v) const { return !(*this == v); }
+			Vector2 operator+(const Vector2& v) const { return Vector2(x + v.x, y + v.y); }
+			Vector2 operator-(const Vector2& v) const { return Vector2(x - v.x, y - v.y); }
+			Vector2 operator*(float s) const { return Vector2(x * s, y * s); }
+			Vector2 operator/(float s) const { return Vector2(x / s, y / s); }
+			static Vector2 Min(const Vector2& a, const Vector2& b) { return Vector2(a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y); }
+			static Vector2 Max(const Vector2& a, const Vector2& b) { return Vector2(a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y); }
+			// as a point, w = 1, like XMVector2Transform()
+			static Vector2 Transform(const Vector2& v, const Matrix& m)
+			{
+				return Vector2(v.x * m.m[0][0] + v.y * m.m[1][0] + m.m[3][0], v.x * m.m[0][1] + v.y * m.m[1][1] + m.m[3][1]);
+			}
+		};
+	}
+}
@@ -1,26 +1,15 @@
 #include "pch.h"
 #include "FileHandler.h"
+#include "WorkQueue.h"
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 
-bool FileHandler::FileExists(const std::string& filename)
-{
-	std::ifstream file(filename.c_str());
-	return file.good();
-}
-
-void FileHandler::WriteConfig(int credits, int shapeSize, int gameTime)
-{
-	std::ofstream myfile(CONFIG_FILE);
-	myfile << credits << "\n" << shapeSize << "\n" << gameTime;
-}
-
-int FileHandler::ReadCreditsFromFile()
+static int ClampCredits(long long credits)
 {
-	std::fstream myfile(CONFIG_FILE);
-	GotoLine(myfile, 1);
-	int64_t credits;
-	myfile >> credits;
 	if (credits > INT_MAX)
 		return INT_MAX;
 	else if (credits < 0)
@@ -29,40 +18,214 @@ int FileHandler::ReadCreditsFromFile()
 	return (int)credits;
 }
 
-int FileHandler::ReadShapeSizeFromFile()
+static int ClampShapeSize(long long shapeSize)
 {
-	std::fstream myfile(CONFIG_FILE);
-	GotoLine(myfile, 2);
-	int shapeSize;
-	myfile >> shapeSize;
 	if (shapeSize > SHAPE_SIZE_MAX)
 		return SHAPE_SIZE_MAX;
 	else if (shapeSize < 1)
 		return DEFAULT_SHAPE_SIZE;
 
-	return shapeSize;
+	return (int)shapeSize;
 }
 
-int FileHandler::ReadGameTimeFromFile()
+static int ClampGameTime(long long gameTime)
 {
-	std::fstream myfile(CONFIG_FILE);
-	GotoLine(myfile, 3);
-	int gameTime;
-	myfile >> gameTime;
 	if (gameTime > GAME_TIME_MAX)
 		return GAME_TIME_MAX;
 	else if (gameTime < 1)
 		return DEFAULT_GAME_TIME;
 
-	return gameTime;
+	return (int)gameTime;
+}
+
+bool SwapInFile(const char* temp, const char* target)
+{
+#ifdef _WIN32
+	return MoveFileExA(temp, target, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	// replaces target atomically, POSIX guarantees there is no moment without it
+	return rename(temp, target) == 0;
+#endif
+}
+
+bool FileHandler::FileExists(const std::string& filename)
+{
+	fileOpens++;
+	std::ifstream file(filename.c_str());
+	return file.good();
+}
+
+void FileHandler::LoadConfig()
+{
+	config = Config();
+	dirty = false;
+
+	fileOpens++;
+	std::ifstream myfile(CONFIG_FILE);
+	if (!myfile.good())
+	{
+		// no config yet, write the defaults
+		dirty = true;
+		return;
+	}
+	ParseConfig(myfile);
+}
+
+// Reads config.txt in a single pass. Version 1 files are the old positional
+// format (credits, shape size and game time on the first three lines) and get
+// rewritten in the key=value format on the next save, so do files of any other
+// version. Keys this version doesn't know are skipped.
+void FileHandler::ParseConfig(std::istream& file)
+{
+	long long values[3] = { 0, 0, 0 };
+	int legacyLine = 0;
+	int version = 0;
+	bool keyed = false;
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		size_t split = line.find('=');
+		if (split == std::string::npos)
+		{
+			// positional line of a version 1 file
+			if (!keyed && legacyLine < 3)
+				values[legacyLine++] = strtoll(line.c_str(), nullptr, 10);
+			continue;
+		}
+
+		keyed = true;
+		const std::string key = line.substr(0, split);
+		const long long value = strtoll(line.c_str() + split + 1, nullptr, 10);
+		if (key == "version")
+			version = (int)value;
+		else if (key == "credits")
+			config.credits = ClampCredits(value);
+		else if (key == "shapeSize")
+			config.shapeSize = ClampShapeSize(value);
+		else if (key == "gameTime")
+			config.gameTime = ClampGameTime(value);
+		else if (key == "useGravity")
+			config.useGravity = value != 0;
+		else if (key == "epilepticMode")
+			config.epilepticMode = value != 0;
+		else if (key == "useOwnShape")
+			config.useOwnShape = value != 0;
+	}
+
+	// no keys at all, the old positional format
+	if (!keyed)
+	{
+		config.credits = ClampCredits(values[0]);
+		config.shapeSize = ClampShapeSize(values[1]);
+		config.gameTime = ClampGameTime(values[2]);
+		dirty = true;
+	}
+	// a missing, broken or other version keeps what it read and gets rewritten
+	else if (version != CONFIG_VERSION)
+		dirty = true;
+}
+
+void FileHandler::SaveConfig()
+{
+	CheckFailedSave();
+	if (!dirty)
+		return;
+
+	if (diskQueue)
+	{
+		const Config saved = config;
+		diskQueue->Push([this, saved]()
+		{
+			if (!WriteConfig(saved))
+				saveFailed = true;
+		});
+	}
+	// keep the changes and try again later, a failed save must not look like a done one
+	else if (!WriteConfig(config))
+	{
+		saveScheduled = true;
+		saveDelay = CONFIG_SAVE_DELAY;
+		return;
+	}
+	dirty = false;
+	saveScheduled = false;
+}
+
+void FileHandler::CheckFailedSave()
+{
+	if (!saveFailed.exchange(false))
+		return;
+
+	dirty = true;
+	saveScheduled = true;
+	saveDelay = CONFIG_SAVE_DELAY;
+}
+
+void FileHandler::ScheduleSave()
+{
+	if (!dirty)
+		return;
+
+	saveScheduled = true;
+	saveDelay = CONFIG_SAVE_DELAY;
+}
+
+void FileHandler::Update(double elapsedSeconds)
+{
+	CheckFailedSave();
+	if (!saveScheduled)
+		return;
+
+	saveDelay -= elapsedSeconds;
+	if (saveDelay <= 0.0)
+		SaveConfig();
+}
+
+void FileHandler::SetConfig(int credits, int shapeSize, int gameTime)
+{
+	if (config.credits == credits && config.shapeSize == shapeSize && config.gameTime == gameTime)
+		return;
+
+	config.credits = credits;
+	config.shapeSize = shapeSize;
+	config.gameTime = gameTime;
+	dirty = true;
+}
+
+void FileHandler::SetOptions(bool useGravity, bool epilepticMode, bool useOwnShape)
+{
+	if (config.useGravity == useGravity && config.epilepticMode == epilepticMode && config.useOwnShape == useOwnShape)
+		return;
+
+	config.useGravity = useGravity;
+	config.epilepticMode = epilepticMode;
+	config.useOwnShape = useOwnShape;
+	dirty = true;
 }
 
-std::fstream& FileHandler::GotoLine(std::fstream& file, unsigned int num)
+bool FileHandler::WriteConfig(const Config& saved)
 {
-	file.seekg(std::ios::beg);
-	for (UINT8 i = 0; i < num - 1; ++i)
+	// Write to a temp file first and swap it in, so a crash mid-write never
+	// leaves a truncated config.txt behind
+	fileOpens++;
 	{
-		file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		std::ofstream myfile(CONFIG_TEMP_FILE, std::ios::trunc);
+		myfile << "version=" << CONFIG_VERSION << "\n"
+			<< "credits=" << saved.credits << "\n"
+			<< "shapeSize=" << saved.shapeSize << "\n"
+			<< "gameTime=" << saved.gameTime << "\n"
+			<< "useGravity=" << saved.useGravity << "\n"
+			<< "epilepticMode=" << saved.epilepticMode << "\n"
+			<< "useOwnShape=" << saved.useOwnShape << "\n";
+		myfile.flush();
+		if (!myfile.good())
+			return false;
 	}
-	return file;
-}
\ No newline at end of file
+	return SwapInFile(CONFIG_TEMP_FILE, CONFIG_FILE);
+}
@@ -1,23 +1,72 @@
 #pragma once
 
+#include <atomic>
 #include <fstream>
 #include <limits>
+#include "GameSize.h"
+
+class WorkQueue;
 
-#define GAME_WIDTH 1000
-#define GAME_HEIGHT 600
 #define CONFIG_FILE "config.txt"
+#define CONFIG_TEMP_FILE "config.txt.tmp"
+#define CONFIG_VERSION 2
+// seconds to wait after the last change before flushing to disk
+#define CONFIG_SAVE_DELAY 0.5
 #define GAME_TIME_MAX 30
 #define SHAPE_SIZE_MAX GAME_HEIGHT
 #define DEFAULT_GAME_TIME 5
 #define DEFAULT_SHAPE_SIZE 200
 
+// Moves a fully written temp file over target in one step, whoever opens target sees the
+// old file or the new one and never a mix. MoveFileExA() on Windows, rename() elsewhere.
+bool SwapInFile(const char* temp, const char* target);
+
+// Everything stored in config.txt
+struct Config
+{
+	int credits = 0;
+	int shapeSize = DEFAULT_SHAPE_SIZE;
+	int gameTime = DEFAULT_GAME_TIME;
+	bool useGravity = false;
+	bool epilepticMode = false;
+	bool useOwnShape = false;
+};
+
 class FileHandler
 {
 public:
 	bool FileExists(const std::string& filename);
-	void WriteConfig(int credits, int shapeSize, int gameTime);
-	int ReadCreditsFromFile();
-	int ReadShapeSizeFromFile();
-	int ReadGameTimeFromFile();
-	std::fstream& GotoLine(std::fstream& file, unsigned int num);
-};
\ No newline at end of file
+	// Settings are read from disk once and served from memory afterwards,
+	// SaveConfig() only touches the disk when something changed
+	void LoadConfig();
+	void SaveConfig();
+	// With a queue SaveConfig() writes a copy of the settings there and returns right away,
+	// a write that fails marks them changed again on the next Update() or SaveConfig()
+	void SetDiskQueue(WorkQueue* queue) { diskQueue = queue; }
+	// Defers SaveConfig() until no change happened for CONFIG_SAVE_DELAY seconds,
+	// Update() is driven from the game loop so bursts of clicks cost one write
+	void ScheduleSave();
+	void Update(double elapsedSeconds);
+	void SetConfig(int credits, int shapeSize, int gameTime);
+	void SetOptions(bool useGravity, bool epilepticMode, bool useOwnShape);
+	const Config& GetConfig() const { return config; }
+	int GetCredits() const { return config.credits; }
+	int GetShapeSize() const { return config.shapeSize; }
+	int GetGameTime() const { return config.gameTime; }
+	bool IsDirty() const { return dirty; }
+	unsigned int GetFileOpens() const { return fileOpens; }
+private:
+	void ParseConfig(std::istream& file);
+	// false when config.txt was left as it was, safe to run on the disk queue
+	bool WriteConfig(const Config& saved);
+	// picks up a failed write from the disk queue
+	void CheckFailedSave();
+	Config config;
+	bool dirty = false;
+	bool saveScheduled = false;
+	double saveDelay = 0.0;
+	WorkQueue* diskQueue = nullptr;
+	std::atomic<bool> saveFailed{ false };
+	// debug counter, every time config.txt gets opened
+	std::atomic<unsigned int> fileOpens{ 0 };
+};
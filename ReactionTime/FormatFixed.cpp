@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "FormatFixed.h"
+#include <cmath>
+#include <cwchar>
+#include <stdint.h>
+
+namespace
+{
+	const double Pow10[HUD_MAX_DECIMALS + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+	// every integer below this is a double, products past it are left to the C library
+	const double ExactIntegers = 9007199254740992.0;
+
+	int clampDecimals(int decimals)
+	{
+		return decimals < 0 ? 0 : (decimals > HUD_MAX_DECIMALS ? HUD_MAX_DECIMALS : decimals);
+	}
+}
+
+double RoundFixed(double value, int decimals)
+{
+	decimals = clampDecimals(decimals);
+	const double magnitude = std::fabs(value);
+	const double product = magnitude * Pow10[decimals];
+	if (!(product < ExactIntegers))
+		return value < 0.0 ? -product : product;
+
+	// product was rounded once already, fma gives back exactly what that lost,
+	// rounding product + 0.5 again is what turned 1.2345 into 1.235
+	const double error = std::fma(magnitude, Pow10[decimals], -product);
+	double whole = std::floor(product);
+	const double fraction = product - whole;
+	// fraction - 0.5 is exact in these cases, below 0.25 the error is too small to reach a half
+	if (fraction >= 0.25 || fraction == 0.0)
+	{
+		const double overHalf = fraction - 0.5;
+		if (overHalf > -error || (overHalf == -error && std::fmod(whole, 2.0) != 0.0))
+			whole += 1.0;
+	}
+	return std::signbit(value) ? -whole : whole;
+}
+
+size_t FormatFixed(wchar_t* out, size_t size, const wchar_t* label, double value, int decimals)
+{
+	if (size == 0)
+		return 0;
+	decimals = clampDecimals(decimals);
+
+	size_t length = 0;
+	for (; *label && length + 1 < size; label++)
+		out[length++] = *label;
+
+	const double scaled = std::fabs(RoundFixed(value, decimals));
+	// nan, inf and the few digits past 2^53 are left to the C library, none of them allocate
+	if (!(scaled < ExactIntegers))
+	{
+		const int written = std::swprintf(out + length, size - length, L"%.*f", decimals, value);
+		return written < 0 ? length : length + written;
+	}
+
+	// digits backwards into a scratch buffer, then copied in order
+	wchar_t digits[24];
+	int count = 0;
+	uint64_t n = static_cast<uint64_t>(scaled);
+	do
+	{
+		digits[count++] = static_cast<wchar_t>(L'0' + n % 10);
+		n /= 10;
+		// the integer part needs at least one digit in front of the point
+	} while (n > 0 || count <= decimals);
+
+	// printf keeps the sign of values that round to zero, -0.0 included
+	if (std::signbit(value) && length + 1 < size)
+		out[length++] = L'-';
+	for (int i = count - 1; i >= 0 && length + 1 < size; i--)
+	{
+		out[length++] = digits[i];
+		if (i == decimals && decimals > 0 && length + 1 < size)
+			out[length++] = L'.';
+	}
+	out[length] = L'\0';
+	return length;
+}
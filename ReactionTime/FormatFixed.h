@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+
+#define HUD_MAX_DECIMALS 9
+
+// Writes label followed by value with a fixed number of decimals, digit for digit what
+// printf("%.*f") prints, into a caller supplied buffer. Never allocates.
+size_t FormatFixed(wchar_t* out, size_t size, const wchar_t* label, double value, int decimals);
+
+// value times 10^decimals rounded the way FormatFixed() shows it: the exact binary value
+// to the nearest integer, ties to even
+double RoundFixed(double value, int decimals);
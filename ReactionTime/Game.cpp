@@ -3,8 +3,8 @@
 #include <string>       // std::string
 #include <iostream>     // std::cout
 #include <sstream>      // std::stringstream
-#include <numeric>      // std::accumulate
-#include <algorithm>    // std::min_element
+#include <algorithm>    // std::max
+#include <cmath>        // std::ceil
 #include <time.h>       // time
 #include "FileHandler.h"
 #include "ShapeColors.h"
@@ -14,15 +14,60 @@
 #include <thread>
 #include <functional>
 #include "Buttons.h"
+#include "ShapeTransform.h"
+#include "History.h"
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
 
 #define GRID_RESOLUTION 20.0f
+// days of history the end menu median looks back
+#define HISTORY_DAYS 30
+// update rates, only gameplay needs the fine grained step
+#define PLAY_TICK_RATE 1000.0
+#define MENU_TICK_RATE 60.0
+// run Update() on its own thread, 0 runs it in Tick() right before Render() again
+#define SIMULATION_THREAD 1
 
 using namespace Microsoft::WRL;
 using Microsoft::WRL::ComPtr;
 
-Game::Game() : m_window(0), m_featureLevel(D3D_FEATURE_LEVEL_11_1) { }
+#ifdef _DEBUG
+namespace
+{
+	// CRT heap allocations made inside Render(), none once the draw list has grown to the screens
+	std::atomic<unsigned int> renderAllocations{ 0 };
+	thread_local bool rendering = false;
+
+	struct RenderScope
+	{
+		RenderScope() { rendering = true; }
+		~RenderScope() { rendering = false; }
+	};
+
+	int __cdecl CountRenderAllocations(int allocType, void*, size_t, int blockType, long, const unsigned char*, int)
+	{
+		// the CRT's own blocks are made with the heap locked, leave them alone
+		if (rendering && blockType != _CRT_BLOCK && allocType != _HOOK_FREE)
+			renderAllocations.fetch_add(1, std::memory_order_relaxed);
+		return TRUE;
+	}
+}
+#endif
+
+Game::Game() : fH(new FileHandler()), m_window(0), m_featureLevel(D3D_FEATURE_LEVEL_11_1) { }
 Game::~Game()
 {
+	StopSimulation();
+	input.Stop();
+	diskQueue.Stop();
+	if (frameReady)
+		CloseHandle(frameReady);
+	// the queue is done, the last save happens right here
+	fH->SetDiskQueue(nullptr);
+	fH->SaveConfig();
+	delete fH;
+
 	if (m_audEngine)
 		m_audEngine->Suspend();
 
@@ -34,12 +79,18 @@ Game::~Game()
 void Game::Initialize(HWND window)
 {
 	m_window = window;
+#ifdef _DEBUG
+	_CrtSetAllocHook(CountRenderAllocations);
+#endif
+	QueryCursor();
+	// falls back to handling clicks in WndProc when raw input isn't available
+	input.Start(window);
 
 	CreateDevice();
 	CreateResources();
 
+	// the update rate follows the game state, see TargetElapsedSeconds()
 	m_timer.SetFixedTimeStep(true);
-	m_timer.SetTargetElapsedSeconds(0.001);
 
 	srand(static_cast<unsigned>(time(0)));
 
@@ -58,19 +109,189 @@ void Game::Initialize(HWND window)
 	m_music_i = m_music->CreateInstance();
 	m_music_i->Play(true);
 
-	if (!fH->FileExists(CONFIG_FILE))
-		fH->WriteConfig(0, DEFAULT_SHAPE_SIZE, DEFAULT_GAME_TIME);
+	// creates or migrates config.txt when needed
+	fH->LoadConfig();
+	fH->SaveConfig();
+	// from here on saves happen from the simulation, which mustn't wait for the disk
+	fH->SetDiskQueue(&diskQueue);
+	useGravity = fH->GetConfig().useGravity;
+	EpilepticMode = fH->GetConfig().epilepticMode;
+	useOwnShape = fH->GetConfig().useOwnShape;
+	lifetimeHistogram.Load();
+	lifetimeMedian = lifetimeHistogram.Percentile(50.0);
 	SetGameState(state_null);
+
+	frameReady = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+#if SIMULATION_THREAD
+	StartSimulation();
+#endif
 }
 
 void Game::Tick()
+{
+	// nobody else waits for it here, but the disk queue writes its results under it
+	{
+		std::lock_guard<std::mutex> lock(stateLock);
+		Simulate();
+	}
+	Render();
+}
+
+// Runs every pending update, each one publishes a frame for Render()
+void Game::Simulate()
 {
 	m_timer.Tick([&]()
 	{
 		Update(m_timer);
+		PublishFrame();
 	});
+}
 
-	Render();
+void Game::PublishFrame()
+{
+	Frame& frame = frames.Back();
+	frame.update = m_timer.GetFrameCount();
+	frame.state = gameState;
+	frame.alphaSplash = alphaSplash;
+	frame.splashScreenTimer = splashScreenTimer;
+	frame.countdown = countdownShown;
+	frame.gameTime = gameTime;
+	frame.missed = missed;
+	frame.missPos = missPos;
+	frame.tapped = tapped;
+	frame.alpha = alpha;
+	frame.shape = shape;
+	frame.shapePos = shapePos;
+	frame.randShape = randShape;
+	frame.t = t;
+	frame.r = r;
+	frame.ownShape = ownShape;
+	frame.randColor = randColor;
+	frame.randColorEpileptic = randColorEpileptic;
+	frame.stimulus = stimulusClock.Stimulus();
+	frame.shapesTapped = rtv.size();
+	frame.reactionTime = rtv.empty() ? 0.0 : rtv.back();
+	frame.fastest = GetFastestReactionTime();
+	frame.slowest = GetSlowestReactionTime();
+	frame.average = GetAverageReactionTime();
+	frame.p90 = rtStats.P90();
+	frame.historyMedian = historyMedian;
+	frame.lifetimeMedian = lifetimeMedian;
+	frame.credits = Credits();
+	frame.shapeSize = ShapeSize();
+	frame.gameTimeSetting = GameTime();
+	frame.unlock = unlock;
+	frame.deltaGravity = gravity.deltaGravity;
+	frame.dropCount = gravity.dropCount;
+	frame.deltaForce = gravity.deltaForce;
+	frame.fileOpensPerSecond = fileOpensPerSecond;
+	frame.cursorReadsPerSecond = cursorReadsPerSecond;
+	frame.cursorSyscallsPerSecond = cursorSyscallsPerSecond;
+	frame.presentsPerSecond = presentsPerSecond;
+	frame.renderAllocationsPerSecond = renderAllocationsPerSecond;
+	frame.logFailures = sessionLog.GetFailures();
+	frame.logDropped = sessionLog.GetDropped();
+	frame.stateCpu = stateCpu.Percent(gameState);
+	frame.presentDelay = stimulusClock.PresentDelay();
+	frame.updateJitter = updateJitter.Stats().P99();
+
+	// menus mostly stand still, don't wake the renderer for a frame it already shows
+	if (lastPublished.update != 0 && SameFrame(frame, lastPublished))
+		return;
+	lastPublished = frame;
+	frames.Publish();
+
+	if (frameReady)
+		SetEvent(frameReady);
+}
+
+// Compares what the screens show, the update counter doesn't count
+bool Game::SameFrame(const Frame& a, const Frame& b)
+{
+	if (a.state != b.state || a.alphaSplash != b.alphaSplash || a.splashScreenTimer != b.splashScreenTimer ||
+		a.countdown != b.countdown || a.gameTime != b.gameTime || a.missed != b.missed || a.missPos != b.missPos ||
+		a.tapped != b.tapped || a.alpha != b.alpha || a.shape != b.shape || a.shapePos != b.shapePos ||
+		a.randShape != b.randShape || a.randColor != b.randColor || a.randColorEpileptic != b.randColorEpileptic ||
+		a.stimulus != b.stimulus)
+		return false;
+	if (a.t.x != b.t.x || a.t.y != b.t.y || a.t.r != b.t.r || a.r.x != b.r.x || a.r.y != b.r.y || a.r.r != b.r.r ||
+		a.ownShape.x != b.ownShape.x || a.ownShape.y != b.ownShape.y || a.ownShape.r != b.ownShape.r)
+		return false;
+	if (a.shapesTapped != b.shapesTapped || a.reactionTime != b.reactionTime || a.fastest != b.fastest ||
+		a.slowest != b.slowest || a.average != b.average || a.p90 != b.p90 || a.historyMedian != b.historyMedian ||
+		a.lifetimeMedian != b.lifetimeMedian || a.credits != b.credits || a.shapeSize != b.shapeSize ||
+		a.gameTimeSetting != b.gameTimeSetting || a.unlock != b.unlock)
+		return false;
+#ifdef _DEBUG
+	// the rest of the overlay is only shown while playing, which changes every update anyway
+	if (a.cursorReadsPerSecond != b.cursorReadsPerSecond || a.cursorSyscallsPerSecond != b.cursorSyscallsPerSecond ||
+		a.presentsPerSecond != b.presentsPerSecond || a.renderAllocationsPerSecond != b.renderAllocationsPerSecond ||
+		a.logFailures != b.logFailures || a.logDropped != b.logDropped || a.stateCpu != b.stateCpu)
+		return false;
+#endif
+	return true;
+}
+
+void Game::StartSimulation()
+{
+	if (simulating)
+		return;
+
+	simulating = true;
+	simulation = std::thread(&Game::RunSimulation, this);
+}
+
+void Game::StopSimulation()
+{
+	if (!simulation.joinable())
+		return;
+
+	simulating = false;
+	simulation.join();
+}
+
+void Game::RunSimulation()
+{
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+
+	// same pacing as the serial main loop, sleep until the next update is due
+	bool highResolutionTimer = true;
+	HANDLE waitTimer = CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (!waitTimer)
+	{
+		highResolutionTimer = false;
+		waitTimer = CreateWaitableTimerEx(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	}
+
+	while (simulating)
+	{
+		double wait;
+		{
+			std::lock_guard<std::mutex> lock(stateLock);
+			if (GetGameState(state_suspended))
+				wait = 0.001;
+			else
+			{
+				Simulate();
+				wait = m_timer.GetSecondsUntilNextUpdate();
+			}
+		}
+
+		// a low resolution timer can't hit sub-tick waits, spin for those
+		if (waitTimer && wait > 0.0 && (highResolutionTimer || wait > 0.002))
+		{
+			// negative due time is relative, in 100 ns units
+			LARGE_INTEGER dueTime;
+			dueTime.QuadPart = -static_cast<LONGLONG>(wait * 10000000.0);
+			if (SetWaitableTimer(waitTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+				WaitForSingleObject(waitTimer, INFINITE);
+		}
+		else if (wait > 0.0)
+			std::this_thread::yield();
+	}
+
+	if (waitTimer)
+		CloseHandle(waitTimer);
 }
 
 void Game::ControlSound()
@@ -86,41 +307,29 @@ void Game::StartScreen()
 
 }
 
-void Game::StartTimer()
+double Game::GetTime()
 {
-	startTimer = std::chrono::high_resolution_clock::now();
+	return GetTime(std::chrono::high_resolution_clock::now());
 }
 
-double Game::GetTime()
+double Game::GetTime(TimePoint eventTime)
 {
-	endTimer = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> elapsed_seconds = endTimer - startTimer;
-	return elapsed_seconds.count();
+	return stimulusClock.Elapsed(eventTime);
 }
 
 double Game::GetFastestReactionTime()
 {
-	if ((rtv.size()) == NULL)
-		return 0;
-
-	return *std::min_element(rtv.begin(), rtv.end());
+	return rtStats.Min();
 }
 
 double Game::GetSlowestReactionTime()
 {
-	if ((rtv.size()) == NULL)
-		return 0;
-
-	return *std::max_element(rtv.begin(), rtv.end());
+	return rtStats.Max();
 }
 
 double Game::GetAverageReactionTime()
 {
-	if ((rtv.size()) == NULL)
-		return 0;
-
-	double sum = std::accumulate(rtv.begin(), rtv.end(), 0.0);
-	return sum / rtv.size();
+	return rtStats.Mean();
 }
 
 std::string getDate()
@@ -162,31 +371,22 @@ float Game::RandomFloat(float min, float max)
 void Game::ShowText(const wchar_t* widecstr, float x, float y, FXMVECTOR color, float rotation, float scale)
 {
 	Vector2 origin = m_font->MeasureString(widecstr) / 2.0f;
-	m_spriteBatch->Begin();
-	m_font->DrawString(m_spriteBatch.get(), widecstr, XMFLOAT2(x, y), color, rotation, origin, scale);
-	m_spriteBatch->End();
+	drawList.AddText(widecstr, x, y, color, rotation, scale, origin);
 }
 
-void Game::ShowTime(std::string text, double value, std::streamsize decimals, float x, float y, FXMVECTOR color, float rotation, float scale)
+void Game::ShowTime(HudSlot slot, const wchar_t* text, double value, int decimals, float x, float y, FXMVECTOR color, float rotation, float scale)
 {
-	std::string result;
-	std::stringstream ss;
-	
-	ss << std::fixed << std::setprecision(decimals) << text << value;
-	result = ss.str();
-	std::wstring widestr = std::wstring(result.begin(), result.end());
-	const wchar_t* widecstr = widestr.c_str();
-	Vector2 origin = m_font->MeasureString(widecstr) / 2.0f;
-
-	m_spriteBatch->Begin();
-	m_font->DrawString(m_spriteBatch.get(), widecstr, XMFLOAT2(x, y), color, rotation, origin, scale);
-	m_spriteBatch->End();
+	HudText& hud = hudText[slot];
+	if (hud.Set(text, value, decimals))
+		XMStoreFloat2(&hud.origin, m_font->MeasureString(hud.Text()) / 2.0f);
+	drawList.AddText(hud.Text(), x, y, color, rotation, scale, hud.origin);
 }
 
 void Game::StartCountdown()
 {
 	m_music_i->SetVolume(0.5f);
 	countdownTime = 3;
+	countdownShown = 0;
 	SetGameState(state_countdown);
 }
 
@@ -194,9 +394,11 @@ void Game::StartGame()
 {
 	// Clear time vector before we start
 	rtv.clear();
+	rtStats.Reset();
+	sessionHistogram.Reset();
 	calculateRandomColors();
 	GenerateShape();
-	gameTime = fH->ReadGameTimeFromFile();
+	gameTime = GameTime();
 	if (!crazyGame)
 		SetGameState(state_play);
 	else
@@ -210,48 +412,30 @@ double fRand(double fMin, double fMax)
 	return fMin + f * (fMax - fMin);
 }
 
-void Game::CreateTriangle()
+void Game::CreateTriangle(const Frame& frame)
 {
+	const int randColor = frame.randColor;
+	const Shape& t = frame.t;
 	XMVECTORF32 randomColor = { ColorList[randColor].r, ColorList[randColor].b, ColorList[randColor].g, ColorList[randColor].a };
 
-	m_effect->Apply(m_d3dContext.Get());
-	m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-	VertexPositionColor v1(Vector2(t.x + t.r, t.y - ShapeSize() + t.r), randomColor);
-	VertexPositionColor v2(Vector2(t.x, t.y + t.r), randomColor);
-	VertexPositionColor v3(Vector2(t.x - ShapeSize() + t.r, t.y - t.r), randomColor);
-	m_batch->Begin();
-	m_batch->DrawTriangle(v1, v2, v3);
-	m_batch->End();
+	drawList.AddStatic(triangleMesh, TriangleWorld(t.x, t.y, t.r, (float)frame.shapeSize), randomColor);
 }
 
-void Game::CreateRectangle()
+void Game::CreateRectangle(const Frame& frame)
 {
+	const int randColor = frame.randColor;
+	const Shape& r = frame.r;
 	XMVECTORF32 randomColor = { ColorList[randColor].r, ColorList[randColor].b, ColorList[randColor].g, ColorList[randColor].a };
 
-	m_effect->Apply(m_d3dContext.Get());
-	m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-	VertexPositionColor v1(Vector2(r.x, r.y - ShapeSize() + r.r), randomColor);
-	VertexPositionColor v2(Vector2(r.x - r.r, r.y), randomColor);
-	VertexPositionColor v3(Vector2(r.x - ShapeSize(), r.y - r.r), randomColor);
-	VertexPositionColor v4(Vector2(r.x - ShapeSize() + r.r, r.y - ShapeSize()), randomColor);
-	m_batch->Begin();
-	m_batch->DrawQuad(v1, v2, v3, v4);
-	m_batch->End();
+	drawList.AddStatic(rectangleMesh, RectangleWorld(r.x, r.y, r.r, (float)frame.shapeSize), randomColor);
 }
 
-bool Game::checkIfOwnShapeInWindow()
+void Game::PlaceOwnShape()
 {
-	ownShape.x = RandomFloat(-GAME_WIDTH, GAME_WIDTH);
-	ownShape.y = RandomFloat(-GAME_HEIGHT, GAME_HEIGHT);
-	for (int i = 0; i < ownButtonShape; i++)
-	{
-		if (MousePoint[i].x + ownShape.x > GAME_WIDTH ||
-			(MousePoint[i].x + ownShape.x) < 0.0f ||
-			(MousePoint[i].y + ownShape.y) > GAME_HEIGHT ||
-			(MousePoint[i].y + ownShape.y) < 0.0f)
-			return false;
-	}
-	return true;
+	const float u = RandomFloat(0.0f, 1.0f);
+	const Vector2 offset = PlaceInWindow(ownShapeMin, ownShapeMax, u, RandomFloat(0.0f, 1.0f));
+	ownShape.x = offset.x;
+	ownShape.y = offset.y;
 }
 
 void Game::GenerateShape()
@@ -260,13 +444,7 @@ void Game::GenerateShape()
 		randColor = rand() % 20;
 	if (!useOwnShape)
 	{
-		descending = true;
-		ascending = false;
-		forceRight = false;
-		forceLeft = false;
-		deltaForce = 0.0f;
-		deltaGravity = 0.0f;
-		dropCount = 1;
+		gravity.Reset();
 		randShape = rand() % shape_max;
 		switch (randShape)
 		{
@@ -288,25 +466,17 @@ void Game::GenerateShape()
 	}
 	else
 	{
-		if (drawShape)
-		{
-			if (ownButtonShape > 2 && ownButtonShape < maxLines)
-			{
-				if (!checkIfOwnShapeInWindow())
-				{
-					GenerateShape();
-					return;
-				}
-			}
-		}
+		if (drawShape && ownButtonShape > 2)
+			PlaceOwnShape();
 	}
-	StartTimer();
+	// the reaction timer starts once the shape is presented, see Present()
+	stimulusClock.Generate(std::chrono::high_resolution_clock::now());
 	ClickedOnce = false;
 }
 
-void Game::ShapeTapped()
+void Game::ShapeTapped(TimePoint inputTime)
 {
-	if (ClickedOnce)
+	if (ClickedOnce || stimulusClock.Pending())
 		return;
 	
 	ClickedOnce = true;
@@ -316,7 +486,10 @@ void Game::ShapeTapped()
 	shapeTimer = 0.0;
 	alpha = 1.0f;
 	fadeTimer = 0.0;
-	rtv.insert(rtv.end(), GetTime());
+	rtv.insert(rtv.end(), GetTime(inputTime));
+	rtStats.Add(rtv.back());
+	sessionHistogram.Record(rtv.back());
+	LogSample(true, rtv.back());
 	m_tapped_i = m_right->CreateInstance();
 	m_tapped_i->SetVolume(0.6f);
 	m_tapped_i->Play();
@@ -324,8 +497,9 @@ void Game::ShapeTapped()
 		GenerateShape();
 }
 
-void Game::ShapeMissed()
+void Game::ShapeMissed(TimePoint inputTime)
 {
+	LogSample(false, GetTime(inputTime));
 	gameTime -= 1.0;
 	m_missed_i = m_wrong->CreateInstance();
 	m_missed_i->SetVolume(0.3f);
@@ -335,33 +509,175 @@ void Game::ShapeMissed()
 	missTimer = 0.0;
 }
 
+void Game::LogSample(bool hit, double reactionTime)
+{
+	SessionRecord record;
+	record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	sessionFirstSample = std::min(sessionFirstSample, record.timestamp);
+	record.reactionTime = (float)reactionTime;
+	record.presentDelay = (float)stimulusClock.PresentDelay();
+	record.size = (uint16_t)ShapeSize();
+	record.flags = 0;
+	if (useOwnShape)
+	{
+		record.shape = shape_max;
+		record.x = ownShape.x;
+		record.y = ownShape.y;
+		record.flags |= session_ownShape;
+	}
+	else
+	{
+		record.shape = (uint8_t)randShape;
+		record.x = randShape == shape_triangle ? t.x : r.x;
+		record.y = randShape == shape_triangle ? t.y : r.y;
+	}
+	if (hit)
+		record.flags |= session_hit;
+	if (crazyGame)
+		record.flags |= session_crazy;
+	if (useGravity)
+		record.flags |= session_gravity;
+	if (EpilepticMode)
+		record.flags |= session_epileptic;
+	sessionLog.Append(record);
+}
+
+// Median reaction time over the last HISTORY_DAYS days in the current mode. The session
+// that just ended comes from rtv, the log may or may not have written it yet, so the query
+// stops at its first record. Opening the log can mean rebuilding its index, that runs on
+// the disk queue and the median shows up in the end menu once it is done.
+void Game::QueryHistory()
+{
+	std::vector<float> values(rtv.begin(), rtv.end());
+	HistoryQuery query;
+	query.from = std::chrono::duration_cast<std::chrono::microseconds>((std::chrono::system_clock::now() - std::chrono::hours(24 * HISTORY_DAYS)).time_since_epoch()).count();
+	query.to = sessionFirstSample;
+	query.flagMask = session_hit | session_crazy | session_gravity | session_ownShape;
+	query.flagValue = session_hit;
+	if (crazyGame)
+		query.flagValue |= session_crazy;
+	if (useGravity)
+		query.flagValue |= session_gravity;
+	if (useOwnShape)
+		query.flagValue |= session_ownShape;
+
+	diskQueue.Push([this, query, values]() mutable
+	{
+		History history;
+		if (history.Open())
+			history.Collect(query, values);
+		const double median = History::Summarize(values).median;
+		std::lock_guard<std::mutex> lock(stateLock);
+		historyMedian = median;
+	});
+}
+
 int Game::ShapeSize()
 {
-	return fH->ReadShapeSizeFromFile();
+	return fH->GetShapeSize();
 }
 
 int Game::GameTime()
 {
-	return fH->ReadGameTimeFromFile();
+	return fH->GetGameTime();
 }
 
 int Game::Credits()
 {
-	return fH->ReadCreditsFromFile();
+	return fH->GetCredits();
+}
+
+// the two triangles PrimitiveBatch::DrawQuad() makes of a quad
+void appendQuad(std::vector<VertexPositionColor>& vertices, const VertexPositionColor& v1, const VertexPositionColor& v2,
+	const VertexPositionColor& v3, const VertexPositionColor& v4)
+{
+	vertices.push_back(v1);
+	vertices.push_back(v2);
+	vertices.push_back(v3);
+	vertices.push_back(v1);
+	vertices.push_back(v3);
+	vertices.push_back(v4);
 }
 
-void Game::CreateButton(UINT8 buttonTag, XMVECTOR color)
+StaticMesh staticMesh(D3D11_PRIMITIVE_TOPOLOGY topology, size_t first, size_t end)
 {
-	assert(buttonTag < MAX_BUTTONS);
-	m_effect->Apply(m_d3dContext.Get());
-	m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-	m_batch->Begin();
-	VertexPositionColor v1(Vector2(ButtonArray[buttonTag][0].x, ButtonArray[buttonTag][0].y), color);
-	VertexPositionColor v2(Vector2(ButtonArray[buttonTag][1].x, ButtonArray[buttonTag][1].y), color);
-	VertexPositionColor v3(Vector2(ButtonArray[buttonTag][2].x, ButtonArray[buttonTag][2].y), color);
-	VertexPositionColor v4(Vector2(ButtonArray[buttonTag][3].x, ButtonArray[buttonTag][3].y), color);
-	m_batch->DrawQuad(v1, v2, v3, v4);
-	m_batch->End();
+	StaticMesh mesh = { topology, static_cast<unsigned int>(first), static_cast<unsigned int>(end - first) };
+	return mesh;
+}
+
+void Game::CreateStaticGeometry()
+{
+	std::vector<VertexPositionColor> vertices;
+
+	size_t first = vertices.size();
+	XMVECTORF32 gridColor = { 0.000000000f, 0.000000000f, 0.000000000f, 0.500000000f };
+	for (uint8_t i = 0; i < GAME_WIDTH / GRID_RESOLUTION; i++)
+	{
+		//vertical
+		vertices.push_back(VertexPositionColor(Vector2(GRID_RESOLUTION*i, 0.0f), gridColor));
+		vertices.push_back(VertexPositionColor(Vector2(GRID_RESOLUTION*i, GAME_HEIGHT), gridColor));
+		//horizontal
+		vertices.push_back(VertexPositionColor(Vector2(0.0f, GRID_RESOLUTION*i), gridColor));
+		vertices.push_back(VertexPositionColor(Vector2(GAME_WIDTH, GRID_RESOLUTION*i), gridColor));
+	}
+	gridMesh = staticMesh(D3D11_PRIMITIVE_TOPOLOGY_LINELIST, first, vertices.size());
+
+	// time, reaction time and shape count panels
+	first = vertices.size();
+	appendQuad(vertices, VertexPositionColor(Vector2(150.0f + 75.0f, 590.0f - 45.0f), Colors::WhiteSmoke), VertexPositionColor(Vector2(150.0f + 75.0f, 590.0f), Colors::WhiteSmoke),
+		VertexPositionColor(Vector2(0.0f, 590.0f), Colors::WhiteSmoke), VertexPositionColor(Vector2(0.0f, 590.0f - 45.0f), Colors::WhiteSmoke));
+	appendQuad(vertices, VertexPositionColor(Vector2(525.0f + 75.0f, 0.0f), Colors::WhiteSmoke), VertexPositionColor(Vector2(525.0f + 75.0f, 50.0f), Colors::WhiteSmoke),
+		VertexPositionColor(Vector2(415.0f, 50.0f), Colors::WhiteSmoke), VertexPositionColor(Vector2(415.0f, 0.0f), Colors::WhiteSmoke));
+	appendQuad(vertices, VertexPositionColor(Vector2(1000.0f, 590 - 45.0f), Colors::WhiteSmoke), VertexPositionColor(Vector2(1000.0f, 590.0f), Colors::WhiteSmoke),
+		VertexPositionColor(Vector2(850.0f - 75.0f, 590.0f), Colors::WhiteSmoke), VertexPositionColor(Vector2(850.0f - 75.0f, 590.0f - 45.0f), Colors::WhiteSmoke));
+	hudMesh = staticMesh(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, first, vertices.size());
+
+	// white, the draw's tint colours them
+	first = vertices.size();
+	for (const Vector2& corner : TriangleCorners)
+		vertices.push_back(VertexPositionColor(corner, Colors::White));
+	triangleMesh = staticMesh(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, first, vertices.size());
+	first = vertices.size();
+	appendQuad(vertices, VertexPositionColor(RectangleCorners[0], Colors::White), VertexPositionColor(RectangleCorners[1], Colors::White),
+		VertexPositionColor(RectangleCorners[2], Colors::White), VertexPositionColor(RectangleCorners[3], Colors::White));
+	rectangleMesh = staticMesh(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, first, vertices.size());
+
+	buttonMeshes.Append(vertices, Colors::Red, Colors::GreenYellow);
+	// the labels never change either, they are measured once with the font
+	for (const ButtonLayout& button : Buttons)
+	{
+		if (button.label)
+			XMStoreFloat2(&buttonMeshes.labelOrigins[button.tag], m_font->MeasureString(button.label) / 2.0f);
+	}
+
+	m_drawBackend->SetStaticVertices(vertices.data(), vertices.size());
+}
+
+bool Game::IsButtonOn(ButtonTag tag)
+{
+	switch (tag)
+	{
+	case button_useOwnShape:
+		return useOwnShape;
+	case button_useGravity:
+		return useGravity;
+	case button_epileptic:
+		return EpilepticMode;
+	default:
+		return false;
+	}
+}
+
+// Every button of the screen in red, green on top where hovered or switched on, then their labels
+void Game::DrawButtons(GameState state)
+{
+	unsigned int switchedOn = 0;
+	for (int tag = 0; tag < button_max; tag++)
+	{
+		if (IsButtonOn(static_cast<ButtonTag>(tag)))
+			switchedOn |= 1u << tag;
+	}
+	buttonMeshes.Record(drawList, state, ButtonUnderCursor(state), switchedOn, Colors::Black);
 }
 
 bool Game::calculateRandomColors()
@@ -381,7 +697,16 @@ void Game::EndGame()
 	m_music_i->SetVolume(1.0f);
 
 	if (Credits() + rtv.size() <= INT_MAX)
-		fH->WriteConfig(Credits() + rtv.size(), ShapeSize(), GameTime());
+		fH->SetConfig(Credits() + rtv.size(), ShapeSize(), GameTime());
+	// this runs under stateLock, every write goes to diskQueue with a copy of what it writes
+	fH->SaveConfig();
+	QueryHistory();
+	sessionFirstSample = INT64_MAX;
+	sessionLog.Flush();
+	lifetimeHistogram.Merge(sessionHistogram);
+	std::shared_ptr<Histogram> lifetime = std::make_shared<Histogram>(lifetimeHistogram);
+	diskQueue.Push([lifetime]() { lifetime->Save(); });
+	lifetimeMedian = lifetimeHistogram.Percentile(50.0);
 
 	missed = false;
 	tapped = false;
@@ -400,10 +725,46 @@ void Game::EndGame()
 
 void Game::SetGameState(GameState state)
 {
+	// the time so far was spent in the state being left
+	ChargeCpu();
 	// don't wanna loop through same state
 	if (state != oldState)
 	   oldState = gameState;
 	gameState = state;
+	m_timer.SetTargetElapsedSeconds(TargetElapsedSeconds(state));
+}
+
+// user and kernel time of every thread of the process
+static double ProcessCpuSeconds()
+{
+	FILETIME creation, exited, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exited, &kernel, &user))
+		return 0.0;
+	ULARGE_INTEGER kernelTime, userTime;
+	kernelTime.LowPart = kernel.dwLowDateTime;
+	kernelTime.HighPart = kernel.dwHighDateTime;
+	userTime.LowPart = user.dwLowDateTime;
+	userTime.HighPart = user.dwHighDateTime;
+	// in 100 ns units
+	return (kernelTime.QuadPart + userTime.QuadPart) * 1e-7;
+}
+
+void Game::ChargeCpu()
+{
+	std::chrono::duration<double> wall = std::chrono::steady_clock::now().time_since_epoch();
+	stateCpu.Charge(gameState, ProcessCpuSeconds(), wall.count());
+}
+
+double Game::TargetElapsedSeconds(GameState state)
+{
+	switch (state)
+	{
+	case state_play:
+	case state_playcrazy:
+		return 1.0 / PLAY_TICK_RATE;
+	default:
+		return 1.0 / MENU_TICK_RATE;
+	}
 }
 
 bool Game::GetGameState(GameState state, bool last)
@@ -447,36 +808,42 @@ void Game::CursorClipCheck()
 	}
 }
 
-void Game::CreateOwnShape()
+void Game::CreateOwnShape(const OwnShape& ownShape, int randColor)
 {
-	if (ownButtonShape > 2 && ownButtonShape < maxLines)
+	if (ownButtonShape > 2)
 	{
 		XMVECTORF32 randomColor = { ColorList[randColor].r, ColorList[randColor].b, ColorList[randColor].g, ColorList[randColor].a };
-		
-		// outside edges
-		for (int i = 0; i < ownButtonShape - 1; i++)
-		{
-			VertexPositionColor v1(Vector2(MousePoint[i].x + ownShape.x, MousePoint[i].y + ownShape.y), randomColor);
-			VertexPositionColor v2(Vector2(MousePoint[i + 1].x + ownShape.x, MousePoint[i + 1].y + ownShape.y), randomColor);
-			VertexPositionColor v3(Vector2(MousePoint[i + 2].x + ownShape.x, MousePoint[i + 2].y + ownShape.y), randomColor);
-		    m_batch->DrawTriangle(v1, v2, v3);
-	    }
-		// inside
-		for (int i = 2; i < ownButtonShape - 2; i += 2)
-		{
-			VertexPositionColor v1(Vector2(MousePoint[i].x + ownShape.x, MousePoint[i].y + ownShape.y), randomColor);
-			VertexPositionColor v2(Vector2(MousePoint[i + 2].x + ownShape.x, MousePoint[i + 2].y + ownShape.y), randomColor);
-			VertexPositionColor v3(Vector2(MousePoint[0].x + ownShape.x, MousePoint[0].y + ownShape.y), randomColor);
-			m_batch->DrawTriangle(v1, v2, v3);
-		}
+
+		// vertices and triangles were made when the shape got closed, only its position changes
+		if (ownShapeTriangles.empty())
+			return;
+		drawList.AddIndexed(ownShapeTriangles.data(), ownShapeTriangles.size(), ownShapeVertices.data(), ownShapeVertices.size(),
+			Matrix::CreateTranslation(ownShape.x, ownShape.y, 0.0f), randomColor);
 	}
 }
 
-void Game::CountDown(double time)
+void Game::QueueTap(TimePoint inputTime, float x, float y)
 {
-	Clear();
-	ShowTime("", time, 0, GAME_WIDTH / 2, 300.0f, Colors::LawnGreen, 0.0f, 1.0f);
-	m_countdown->Play();
+	PointerEvent event = { inputTime, x, y };
+	windowTaps.Push(event);
+}
+
+// Clicks captured by the input thread and taps queued from WndProc, already timestamped and
+// in client coordinates. Runs right after stimulusClock.Process(), the only place taps are judged.
+void Game::ProcessInput()
+{
+	PointerEvent event;
+	while (input.Pop(event) || windowTaps.Pop(event))
+	{
+		// menus still get their clicks through WndProc
+		if (!GetGameState(state_play) && !GetGameState(state_playcrazy))
+			continue;
+
+		if (IsCursorInsideShape(Vector2(event.x, event.y)))
+			ShapeTapped(event.time);
+		else
+			ShapeMissed(event.time);
+	}
 }
 
 void Game::Update(DX::StepTimer const& timer)
@@ -484,27 +851,58 @@ void Game::Update(DX::StepTimer const& timer)
 	if (m_timer.GetFrameCount() == 0)
 		return;
 
+	updateJitter.Sample(TargetElapsedSeconds(gameState));
+	stimulusClock.Process();
+	ProcessInput();
+
+	// sample file opens and cursor lookups once per second for the debug overlay
+	if (timer.GetTotalSeconds() - fileOpenSampleTime >= 1.0)
+	{
+		fileOpensPerSecond = fH->GetFileOpens() - lastFileOpens;
+		lastFileOpens = fH->GetFileOpens();
+		cursorReadsPerSecond = cursorReads - lastCursorReads;
+		lastCursorReads = cursorReads;
+		cursorSyscallsPerSecond = cursorSyscalls - lastCursorSyscalls;
+		lastCursorSyscalls = cursorSyscalls;
+		presentsPerSecond = presents - lastPresents;
+		lastPresents = presents;
+#ifdef _DEBUG
+		renderAllocationsPerSecond = renderAllocations - lastRenderAllocations;
+		lastRenderAllocations = renderAllocations;
+#endif
+		fileOpenSampleTime = timer.GetTotalSeconds();
+		ChargeCpu();
+	}
+	fH->Update(timer.GetElapsedSeconds());
+
+	// every timer runs on the real elapsed time, gravity steps through it in GRAVITY_STEPs
+	const double elapsed = timer.GetElapsedSeconds();
+
 	CursorClipCheck();
 	switch (gameState)
 	{
 	case state_null:
-		splashScreenTimer -= 0.001;
-		alphaSplash -= 0.00024f;
+		splashScreenTimer -= elapsed;
+		alphaSplash -= 0.24f * (float)elapsed;
 		if (splashScreenTimer <= 0)
 			SetGameState(state_startmenu);
 		break;
 	case state_countdown:
-		if (countdownTime == 3 || countdownTime < 2.001 && countdownTime > 2 || countdownTime < 1.001 && countdownTime > 1.0)
-			CountDown(countdownTime);
-		else if (countdownTime < 0.001)
+		if (countdownTime <= 0.0)
 			StartGame();
-		countdownTime -= 0.002;
+		else if ((int)std::ceil(countdownTime) != countdownShown)
+		{
+			// show every number once, the countdown runs at double speed
+			countdownShown = (int)std::ceil(countdownTime);
+			m_countdown->Play();
+		}
+		countdownTime -= 2.0 * elapsed;
 		break;
 	case state_play:
 	case state_playcrazy:
 		if (EpilepticMode)
 		{
-			epilepticTimer += 0.001;
+			epilepticTimer += elapsed;
 			if (epilepticTimer >= 0.25)
 			{
 				if (calculateRandomColors())
@@ -512,228 +910,13 @@ void Game::Update(DX::StepTimer const& timer)
 			}
 		}
 		if (useGravity)
-		{
-			if (descending)
-			{
-				// while descending gravity increases, increasing the speed of the descend
-				deltaGravity += 0.0025f;
-				// max gravity
-				if (deltaGravity < 2.5)
-				{
-					switch (randShape)
-					{
-					case shape_triangle:
-						// increase y to make it drop to the floor and check if it's not outside game boundary
-						if (t.y < GAME_HEIGHT && t.y >= 0.0f)
-							t.y = t.y + deltaGravity;
-						if (t.y + t.r >= GAME_HEIGHT)
-						{
-							// check if shape is not outside game boundary
-							if (t.x - ShapeSize() + t.r >= 0 || t.x + t.r >= GAME_WIDTH)
-							{
-								// check if shape is rotated to the left
-								if (t.r < ShapeSize() / 2)
-								{
-									t.r -= deltaGravity;
-								}
-								// check if shape is rotated to the right
-								else if (t.r > ShapeSize() / 2)
-								{
-									t.r += deltaGravity;
-								}
-							}
-							// check if x is not outside left game boundary, otherwise apply right force
-							if (t.x - ShapeSize() + t.r <= 0)
-							{
-								ascending = true;
-								descending = false;
-								forceRight = true;
-								forceLeft = false;
-								dropCount = dropCount + 0.4f;
-							}
-							// check if x is not outside right game boundary, otherwise apply left force
-							else if (t.x - t.r >= GAME_WIDTH)
-							{
-								ascending = true;
-								descending = false;
-								forceLeft = true;
-								forceRight = false;
-								dropCount = dropCount + 0.4f;
-							}
-							// check if the rotation is not outside game boundary otherwise make it bounce back
-							if (t.r < 0)
-							{
-								t.r = 0;
-								ascending = true;
-								descending = false;
-								forceRight = true;
-								forceLeft = false;
-								dropCount = dropCount + 0.4f;
-							}
-							else if (t.r > ShapeSize() / 1)
-							{
-								t.r = (float)ShapeSize() / 1;
-								ascending = true;
-								descending = false;
-								forceLeft = true;
-								forceRight = false;
-								dropCount = dropCount + 0.4f;
-							}
-						}
-						break;
-					case shape_rectangle:
-						// increase y to make it drop to the floor and check if it's not outside game boundary
-						if (r.y < GAME_HEIGHT && r.y > 0.0f)
-							r.y = r.y + deltaGravity;
-						if (r.y >= GAME_HEIGHT)
-						{
-							if (r.x - ShapeSize() + r.r >= 0 || r.x + r.r >= GAME_WIDTH)
-							{
-								// check if shape is rotated to the left
-								if (r.r < ShapeSize() / 2 && r.x - ShapeSize() >= 0.0f)
-								{
-									r.x -= deltaGravity / dropCount;
-									r.y -= deltaGravity / dropCount;
-									r.r -= deltaGravity / dropCount;
-								}
-								// check if shape is rotated to the right
-								else if (r.r > ShapeSize() / 2)
-								{
-									r.r += deltaGravity / dropCount;
-									r.x -= deltaGravity / dropCount;
-									r.y -= deltaGravity / dropCount;
-								}
-							}
-							// check if x is not outside left game boundary, otherwise apply right force
-							if (r.x - ShapeSize() <= 0)
-							{
-								ascending = true;
-								descending = false;
-								forceRight = true;
-								forceLeft = false;
-								dropCount = dropCount + 0.4f;
-							}
-							// check if x is not outside right game boundary, otherwise apply left force
-							else if (r.x - r.r >= GAME_WIDTH)
-							{
-								ascending = true;
-								descending = false;
-								forceLeft = true;
-								forceRight = false;
-								dropCount = dropCount + 0.4f;
-							}
-							// check if the rotation is not outside game boundary otherwise make it bounce back
-							if (r.r < 0)
-							{
-								r.r = 0;
-								ascending = true;
-								descending = false;
-								forceRight = true;
-								forceLeft = false;
-								dropCount = dropCount + 0.4f;
-							}
-							else if (r.r > ShapeSize() / 1)
-							{
-								r.r = (float)ShapeSize() / 1;
-								ascending = true;
-								descending = false;
-								forceLeft = true;
-								forceRight = false;
-								dropCount = dropCount + 0.4f;
-							}
-						}
-						break;
-					}
-				}
-				else
-				{
-					descending = false;
-					ascending = true;
-				}
-			}
-			else if (ascending)
-			{
-				// while ascending gravity decreases, decreasing the speed of the ascend
-				if (deltaGravity > 0.0f)
-				{
-					switch (randShape)
-					{
-					case shape_triangle:
-						// decrease y to make it ascend to the ceiling and check if it's not outside game boundary
-						if (t.y < GAME_HEIGHT - t.r && t.y > 0.0f)
-							deltaGravity -= 0.0025f * dropCount;
-						t.y = t.y - deltaGravity;
-						if (t.y <= 0.0f + ShapeSize())
-						{
-							ascending = false;
-							descending = true;
-							deltaGravity = 0.0;
-						}
-						break;
-					case shape_rectangle:
-						// decrease y to make it ascend to the ceiling and check if it's not outside game boundary
-						if (r.y < GAME_HEIGHT - r.r && r.y > 0.0f)
-							deltaGravity -= 0.0025f  * dropCount;
-						r.y = r.y - deltaGravity;
-						if (r.y <= 0.0f + ShapeSize())
-						{
-							ascending = false;
-							descending = true;
-							deltaGravity = 0.0;
-						}
-						break;
-					}
-				}
-				else
-				{
-					descending = true;
-					ascending = false;
-					deltaGravity = 0.0;
-				}
-			}
-			if (forceRight)
-			{
-				// max force
-				switch (randShape)
-				{
-				case shape_triangle:
-					deltaForce += ((t.r / 1000) / 100) * deltaGravity;
-					if (t.x < GAME_WIDTH && t.x > 0.0f)
-						if ((deltaForce / dropCount) - 0.025f > 0.0f)
-							t.x = t.x + (deltaForce / dropCount) - 0.025f;
-					break;
-				case shape_rectangle:
-					deltaForce += ((r.r / 1000) / 100) * deltaGravity;
-					if (r.x < GAME_WIDTH && r.x > 0.0f)
-						if ((deltaForce / dropCount) - 0.025f > 0.0f)
-							r.x = r.x + (deltaForce / dropCount) - 0.025f;
-					break;
-				}
-			}
-			else if (forceLeft)
-			{
-				// max force
-				switch (randShape)
-				{
-				case shape_triangle:
-					deltaForce -= ((t.r / 1000) / 100) * deltaGravity;
-					t.x = t.x - (deltaForce / dropCount) - 0.02f;
-					break;
-				case shape_rectangle:
-					deltaForce -= ((r.r / 1000) / 100) * deltaGravity;
-					if (r.x < GAME_WIDTH && r.x > 0.0f)
-						if ((deltaForce / dropCount) + 0.025f > 0.0f)
-							r.x = r.x + (deltaForce / dropCount) + 0.025f;
-					break;
-				}
-			}
-		}
+			gravity.Advance(elapsed, randShape == shape_triangle ? t : r, randShape == shape_triangle, ShapeSize());
 
 		if (missed)
 		{
-			missTimer += 0.001;
+			missTimer += elapsed;
 			if (missTimer < 1)
-				missPos += 0.02f;
+				missPos += 20.0f * (float)elapsed;
 			else
 			{
 				missed = false;
@@ -743,10 +926,10 @@ void Game::Update(DX::StepTimer const& timer)
 		}
 		if (tapped)
 		{
-			fadeTimer += 0.001;
+			fadeTimer += elapsed;
 			if (fadeTimer > 0.4)
 			{
-				alpha -= 0.0015f;
+				alpha -= 1.5f * (float)elapsed;
 				if (alpha <= 0.0f)
 				{
 					tapped = false;
@@ -757,9 +940,9 @@ void Game::Update(DX::StepTimer const& timer)
 		}
 		if (shape)
 		{
-			shapeTimer += 0.001;
+			shapeTimer += elapsed;
 			if (shapeTimer < 1)
-				shapePos += 0.02f;
+				shapePos += 20.0f * (float)elapsed;
 			else
 			{
 				shape = false;
@@ -774,14 +957,18 @@ void Game::Update(DX::StepTimer const& timer)
 		}
 		else if (gameTime <= 0.0)
 			EndGame();
-		gameTime -= 0.001;
+		gameTime -= elapsed;
 		break;
 	case state_endmenu:
 		if (buttonDown)
 		{
-			if (mPoint().x >= 185.0f && mPoint().x <= 425.0f && mPoint().y <= 385.0f && mPoint().y >= 335.0f)
-				unlock = mPoint().x - 25.0f;
+			const Vector2 point = mPoint();
+			if (point.x >= 185.0f && point.x <= 425.0f && point.y <= 385.0f && point.y >= 335.0f)
+				unlock = point.x - 25.0f;
 		}
+		// snap to unlocked
+		if (unlock > 370.0f)
+			unlock = 380.0f;
 		break;
 	default:
 		break;
@@ -806,22 +993,38 @@ void Game::Update(DX::StepTimer const& timer)
 // Draws the scene
 void Game::Render()
 {
+#ifdef _DEBUG
+	RenderScope scope;
+#endif
+	// only the latest published frame is drawn, whatever the simulation does meanwhile
+	const bool published = frames.Acquire();
+	const Frame& frame = frames.Front();
+
 	// Don't try to render anything before the first Update.
-	if (m_timer.GetFrameCount() == 0)
+	if (frame.update == 0)
+		return;
+
+	// hover colours and the unlock hint follow the cursor instead of the simulation
+	const ButtonTag hover = ButtonUnderCursor(frame.state);
+	const bool unlockHover = frame.state == state_endmenu && isCursorInsideUnlock();
+	if (!published && !renderDirty && hover == renderedHover && unlockHover == renderedUnlockHover)
 		return;
+	renderDirty = false;
+	renderedHover = hover;
+	renderedUnlockHover = unlockHover;
 
-	if (!GetGameState(state_countdown))
-	    Clear();
+	frameJitter.Sample(TargetElapsedSeconds(frame.state));
+	Clear();
 
-	switch (gameState)
+	switch (frame.state)
 	{
 	    case state_null:
 	    {
-			XMVECTORF32 green = { 0.000000000f, 0.501960814f, 0.000000000f, alphaSplash };
+			XMVECTORF32 green = { 0.000000000f, 0.501960814f, 0.000000000f, frame.alphaSplash };
 	    	ShowText(L"Directx 11", GAME_WIDTH / 2, GAME_HEIGHT / 2- 20.0f, green, 0.0f, 0.6f);
-			if (splashScreenTimer < 5)
+			if (frame.splashScreenTimer < 5)
 			{
-				XMVECTORF32 green = { 0.000000000f, 0.501960814f, 0.000000000f, alphaSplash + 0.35f };
+				XMVECTORF32 green = { 0.000000000f, 0.501960814f, 0.000000000f, frame.alphaSplash + 0.35f };
 				ShowText(L"the way shapes are meant to be made", GAME_WIDTH / 2, 320.0f, green, 0.0f, 0.6f);
 			}
 	    	break;
@@ -830,204 +1033,128 @@ void Game::Render()
 			break;
 		case state_editor:
 		{
-			m_effect->Apply(m_d3dContext.Get());
-			m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-			XMVECTORF32 Red = { 0.000000000f, 0.000000000f, 0.000000000f, 0.500000000f };
-
-			m_batch->Begin();
-			//vertical
-			for (uint8_t i = 0; i < GAME_WIDTH / GRID_RESOLUTION; i++)
-			{
-				//vertical
-				VertexPositionColor v17(Vector2(GRID_RESOLUTION*i, 0.0f), Red);
-				VertexPositionColor v18(Vector2(GRID_RESOLUTION*i, GAME_HEIGHT), Red);
-				m_batch->DrawLine(v17, v18);
-				//horizontal
-				VertexPositionColor v19(Vector2(0.0f, GRID_RESOLUTION*i), Red);
-				VertexPositionColor v20(Vector2(GAME_WIDTH, GRID_RESOLUTION*i), Red);
-				m_batch->DrawLine(v19, v20);
-			}
+			drawList.AddStatic(gridMesh);
 
 			if (drawShape)
 			{
-				CreateOwnShape();
-				m_batch->DrawLine(vertexXM[ownButtonShape], vertexXM[ownButtonShape - 1]);
+				CreateOwnShape(frame.ownShape, frame.randColor);
+				drawList.AddLine(vertexXM[ownButtonShape], vertexXM[ownButtonShape - 1]);
 			}
 			if (ownButtonShape > 1)
 			{
 				for (int i = 0; i < ownButtonShape-1; i++)
 				{
-					m_batch->DrawLine(vertexXM[i], vertexXM[i+1]);
+					drawList.AddLine(vertexXM[i], vertexXM[i+1]);
 				}
 			}
 
-			m_batch->End();
-			IsCursorInsideButton(button_options) ? CreateButton(button_options, Colors::GreenYellow) : CreateButton(button_options, Colors::Red);
-			ShowText(L"Back", OptionsButton[0].x - 70.0f, OptionsButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowTime("ownButtonShape: ", ownButtonShape, 0, GAME_WIDTH / 4, 110.0f, Colors::Crimson, 0.0f, 0.6f);
+			DrawButtons(frame.state);
+			ShowTime(hud_editorPoints, L"ownButtonShape: ", ownButtonShape, 0, GAME_WIDTH / 4, 110.0f, Colors::Crimson, 0.0f, 0.6f);
 			break;
 		}
 		case state_startmenu:
-		{
-			IsCursorInsideButton(button_options) ? CreateButton(button_options, Colors::GreenYellow) : CreateButton(button_options, Colors::Red);
-			IsCursorInsideButton(button_start) ? CreateButton(button_start, Colors::GreenYellow) : CreateButton(button_start, Colors::Red);
-			IsCursorInsideButton(button_crazy) ? CreateButton(button_crazy, Colors::GreenYellow) : CreateButton(button_crazy, Colors::Red);
-			IsCursorInsideButton(button_sound) ? CreateButton(button_sound, Colors::GreenYellow) : CreateButton(button_sound, Colors::Red);
-			IsCursorInsideButton(button_editor) ? CreateButton(button_editor, Colors::GreenYellow) : CreateButton(button_editor, Colors::Red);
-			ShowText(L"Options", OptionsButton[0].x - 70.0f, OptionsButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Start", StartButton[0].x - 90.0f, StartButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Crazy", CrazyButton[0].x - 150.0f, CrazyButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Editor", EditorButton[0].x - 150.0f, EditorButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
+			DrawButtons(frame.state);
 			break;
-		}
 		case state_countdown:
+			ShowTime(hud_countdown, L"", frame.countdown, 0, GAME_WIDTH / 2, 300.0f, Colors::LawnGreen, 0.0f, 1.0f);
 			break;
 	    case state_play:
 	    case state_playcrazy:
 	    {
-			if (gameTime > 0)
+			if (frame.gameTime > 0)
 			{
-				m_effect->Apply(m_d3dContext.Get());
-				m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-				VertexPositionColor v1(Vector2(150.0f + 75.0f, 590.0f - 45.0f), Colors::WhiteSmoke);
-				VertexPositionColor v2(Vector2(150.0f + 75.0f, 590.0f), Colors::WhiteSmoke);
-				VertexPositionColor v3(Vector2(0.0f, 590.0f), Colors::WhiteSmoke);
-				VertexPositionColor v4(Vector2(0.0f, 590.0f - 45.0f), Colors::WhiteSmoke);
-				m_batch->Begin();
-				m_batch->DrawQuad(v1, v2, v3, v4);
-				VertexPositionColor v5(Vector2(525.0f + 75.0f, 0.0f), Colors::WhiteSmoke);
-				VertexPositionColor v6(Vector2(525.0f + 75.0f, 50.0f), Colors::WhiteSmoke);
-				VertexPositionColor v7(Vector2(415.0f, 50.0f), Colors::WhiteSmoke);
-				VertexPositionColor v8(Vector2(415.0f, 0.0f), Colors::WhiteSmoke);
-				m_batch->DrawQuad(v5, v6, v7, v8);
-				VertexPositionColor v9(Vector2(1000.0f, 590 - 45.0f), Colors::WhiteSmoke);
-				VertexPositionColor v10(Vector2(1000.0f, 590.0f), Colors::WhiteSmoke);
-				VertexPositionColor v11(Vector2(850.0f - 75.0f, 590.0f), Colors::WhiteSmoke);
-				VertexPositionColor v12(Vector2(850.0f - 75.0f, 590.0f - 45.0f), Colors::WhiteSmoke);
-				m_batch->DrawQuad(v9, v10, v11, v12);
-				m_batch->End();
-				ShowTime("Time:", gameTime, 2, 110.0f, 570.0f, Colors::Black, 0.0f, 0.8f);
+				drawList.AddStatic(hudMesh);
+				ShowTime(hud_time, L"Time:", frame.gameTime, 2, 110.0f, 570.0f, Colors::Black, 0.0f, 0.8f);
 			}
-			if (missed)
-			    ShowText(L"-1", 105.0f, 520.0f + missPos, Colors::Red, 0.0f, 0.6f);
-			if (tapped)
+			if (frame.missed)
+			    ShowText(L"-1", 105.0f, 520.0f + frame.missPos, Colors::Red, 0.0f, 0.6f);
+			if (frame.tapped)
 			{
-				XMVECTORF32 Red = { 0.392156899f, 0.584313750f, 0.929411829f, alpha };
-				if (GetReactionTime() < 0.1)
+				XMVECTORF32 Red = { 0.392156899f, 0.584313750f, 0.929411829f, frame.alpha };
+				if (frame.reactionTime < 0.1)
 					ShowText(L"Hacker!", GAME_WIDTH / 2, 65.0f, Red, 0.0f, 0.75f);
-				else if (GetReactionTime() < 0.2)
+				else if (frame.reactionTime < 0.2)
 					ShowText(L"Unreal!", GAME_WIDTH / 2, 65.0f, Red, 0.0f, 0.75f);
-				else if (GetReactionTime() < 0.3)
+				else if (frame.reactionTime < 0.3)
 					ShowText(L"Amazing!", GAME_WIDTH / 2, 65.0f, Red, 0.0f, 0.75f);
-				else if (GetReactionTime() < 0.4)
+				else if (frame.reactionTime < 0.4)
 					ShowText(L"Great!", GAME_WIDTH / 2, 65.0f, Red, 0.0f, 0.75f);
 				else
 					ShowText(L"Slow!", GAME_WIDTH / 2, 65.0f, Red, 0.0f, 0.75f);
 			}
-			if (shape)
-				ShowText(L"+1", 885.0f, 520.0f + shapePos, Colors::GreenYellow, 0.0f, 0.6f);
-			if (!rtv.empty())
+			if (frame.shape)
+				ShowText(L"+1", 885.0f, 520.0f + frame.shapePos, Colors::GreenYellow, 0.0f, 0.6f);
+			if (frame.shapesTapped > 0)
 			{
-				ShowTime("", GetReactionTime(), TimeDecimals, GAME_WIDTH / 2, 26.0f, Colors::Black, 0.0f, 1.0f);
-				ShowTime("Shapes:", rtv.size(), 0, 885.0f, 570.0f, Colors::Black, 0.0f, 0.8f);
+				ShowTime(hud_reactionTime, L"", frame.reactionTime, TimeDecimals, GAME_WIDTH / 2, 26.0f, Colors::Black, 0.0f, 1.0f);
+				ShowTime(hud_shapes, L"Shapes:", frame.shapesTapped, 0, 885.0f, 570.0f, Colors::Black, 0.0f, 0.8f);
 			}
 			if (!useOwnShape)
 			{
-				switch (randShape)
+				switch (frame.randShape)
 				{
 				case shape_triangle:
-					CreateTriangle();
+					CreateTriangle(frame);
 					break;
 				case shape_rectangle:
-					CreateRectangle();
+					CreateRectangle(frame);
 					break;
 				}
 			}
-			else
+			else if (drawShape)
 			{
-				m_effect->Apply(m_d3dContext.Get());
-				m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-				m_batch->Begin();
-				if (drawShape)
-				{
-					if (ownButtonShape > 2)
-					    CreateOwnShape();
-				}
-				m_batch->End();
+				if (ownButtonShape > 2)
+				    CreateOwnShape(frame.ownShape, frame.randColor);
 			}
 #ifdef _DEBUG
-			ShowTime("deltaGravity: ", deltaGravity, 5, GAME_WIDTH / 4, 110.0f, Colors::Crimson, 0.0f, 0.6f);
-			ShowTime("dropCount: ", dropCount, 5, GAME_WIDTH / 4, 140.0f, Colors::Crimson, 0.0f, 0.6f);
-			ShowTime("t.y: ", t.y, 5, GAME_WIDTH / 4, 170.0f, Colors::Crimson, 0.0f, 0.6f);
-			ShowTime("t.r: ", t.r, 5, GAME_WIDTH / 4, 200.0f, Colors::Crimson, 0.0f, 0.6f);
-			ShowTime("t.x: ", t.x, 5, GAME_WIDTH / 4, 230.0f, Colors::Crimson, 0.0f, 0.6f);
-			ShowTime("deltaForce: ", deltaForce, 5, GAME_WIDTH / 4, 260.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_deltaGravity, L"deltaGravity: ", frame.deltaGravity, 5, GAME_WIDTH / 4, 110.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_dropCount, L"dropCount: ", frame.dropCount, 5, GAME_WIDTH / 4, 140.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_ty, L"t.y: ", frame.t.y, 5, GAME_WIDTH / 4, 170.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_tr, L"t.r: ", frame.t.r, 5, GAME_WIDTH / 4, 200.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_tx, L"t.x: ", frame.t.x, 5, GAME_WIDTH / 4, 230.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_deltaForce, L"deltaForce: ", frame.deltaForce, 5, GAME_WIDTH / 4, 260.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_fileOpens, L"file opens/s: ", frame.fileOpensPerSecond, 0, GAME_WIDTH / 4, 290.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_presentDelay, L"present delay: ", frame.presentDelay, 5, GAME_WIDTH / 4, 320.0f, Colors::Crimson, 0.0f, 0.6f);
+			// p99 distance from the scheduled interval, compare with SIMULATION_THREAD 0
+			ShowTime(hud_updateJitter, L"update jitter: ", frame.updateJitter, 5, GAME_WIDTH / 4, 350.0f, Colors::Crimson, 0.0f, 0.6f);
+			ShowTime(hud_frameJitter, L"frame jitter: ", frameJitter.Stats().P99(), 5, GAME_WIDTH / 4, 380.0f, Colors::Crimson, 0.0f, 0.6f);
 #endif // DEBUG
 			break;
 	    }
 		case state_optionsmenu:
-			IsCursorInsideButton(button_options) ? CreateButton(button_options, Colors::GreenYellow) : CreateButton(button_options, Colors::Red);
-			IsCursorInsideButton(button_start) ? CreateButton(button_start, Colors::GreenYellow) : CreateButton(button_start, Colors::Red);
-			IsCursorInsideButton(button_crazy) ? CreateButton(button_crazy, Colors::GreenYellow) : CreateButton(button_crazy, Colors::Red);
-			IsCursorInsideButton(button_shapeSizeDown) ? CreateButton(button_shapeSizeDown, Colors::GreenYellow) : CreateButton(button_shapeSizeDown, Colors::Red);
-			IsCursorInsideButton(button_shapeSizeUp) ? CreateButton(button_shapeSizeUp, Colors::GreenYellow) : CreateButton(button_shapeSizeUp, Colors::Red);
-			IsCursorInsideButton(button_gameTimeUp) ? CreateButton(button_gameTimeUp, Colors::GreenYellow) : CreateButton(button_gameTimeUp, Colors::Red);
-			IsCursorInsideButton(button_gameTimeDown) ? CreateButton(button_gameTimeDown, Colors::GreenYellow) : CreateButton(button_gameTimeDown, Colors::Red);
-			IsCursorInsideButton(button_sound) ? CreateButton(button_sound, Colors::GreenYellow) : CreateButton(button_sound, Colors::Red);
-			EpilepticMode ? CreateButton(button_epileptic, Colors::GreenYellow) : CreateButton(button_epileptic, Colors::Red);
-			useGravity ? CreateButton(button_useGravity, Colors::GreenYellow) : CreateButton(button_useGravity, Colors::Red);
-			useOwnShape ? CreateButton(button_useOwnShape, Colors::GreenYellow) : CreateButton(button_useOwnShape, Colors::Red);
-			ShowText(L"Epileptic", EpilepticModeButton[0].x - 70.0f, EpilepticModeButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Use own shape", UseOwnShapeButton[0].x - 70.0f, UseOwnShapeButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Use gravity", UseGravityButton[0].x - 70.0f, UseGravityButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Back", OptionsButton[0].x - 70.0f, OptionsButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"-", ShapeSizeDownButton[0].x - 13.0f, ShapeSizeDownButton[0].y + 11.0f, Colors::Black, 0.0f, 0.7f);
-			ShowText(L"+", ShapeSizeUpButton[0].x - 13.0f, ShapeSizeUpButton[0].y + 11.0f, Colors::Black, 0.0f, 0.7f);
-			ShowText(L"+", GameTimeUpButton[0].x - 13.0f, GameTimeUpButton[0].y + 11.0f, Colors::Black, 0.0f, 0.7f);
-			ShowText(L"-", GameTimeDownButton[0].x - 13.0f, GameTimeDownButton[0].y + 11.0f, Colors::Black, 0.0f, 0.7f);
-			ShowTime("Game Time: ", GameTime(), 0, GAME_WIDTH / 2, 80.0f, Colors::Red, 0.0f, 0.5f);
-			ShowTime("Shape Size: ", ShapeSize(), 0, GAME_WIDTH / 2, 100.0f, Colors::Red, 0.0f, 0.5f);
-			ShowTime("Credits: ", Credits(), 0, GAME_WIDTH / 2, 120.0f, Colors::Red, 0.0f, 0.5f);
+			DrawButtons(frame.state);
+			ShowTime(hud_gameTime, L"Game Time: ", frame.gameTimeSetting, 0, GAME_WIDTH / 2, 80.0f, Colors::Red, 0.0f, 0.5f);
+			ShowTime(hud_shapeSize, L"Shape Size: ", frame.shapeSize, 0, GAME_WIDTH / 2, 100.0f, Colors::Red, 0.0f, 0.5f);
+			ShowTime(hud_credits, L"Credits: ", frame.credits, 0, GAME_WIDTH / 2, 120.0f, Colors::Red, 0.0f, 0.5f);
+			ShowTime(hud_lifetimeMedian, L"Lifetime median: ", frame.lifetimeMedian, TimeDecimals, GAME_WIDTH / 2, 140.0f, Colors::Red, 0.0f, 0.5f);
 			break;
 		case state_endmenu:
 		{
-			IsCursorInsideButton(button_options) ? CreateButton(button_options, Colors::GreenYellow) : CreateButton(button_options, Colors::Red);
-			IsCursorInsideButton(button_start) ? CreateButton(button_start, Colors::GreenYellow) : CreateButton(button_start, Colors::Red);
-			IsCursorInsideButton(button_crazy) ? CreateButton(button_crazy, Colors::GreenYellow) : CreateButton(button_crazy, Colors::Red);
-			IsCursorInsideButton(button_editor) ? CreateButton(button_editor, Colors::GreenYellow) : CreateButton(button_editor, Colors::Red);
-			ShowText(L"Editor", EditorButton[0].x - 150.0f, EditorButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Options", OptionsButton[0].x - 70.0f, OptionsButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Start", StartButton[0].x - 90.0f, StartButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowText(L"Crazy", CrazyButton[0].x - 150.0f, CrazyButton[0].y + 35.0f, Colors::Black, 0.0f, 1.0f);
-			ShowTime("Fastest reaction time: ", GetFastestReactionTime(), TimeDecimals, GAME_WIDTH / 2, 30.0f, Colors::Coral, 0.0f, 1.0f);
-			ShowTime("Slowest reaction time: ", GetSlowestReactionTime(), TimeDecimals, GAME_WIDTH / 2, 30.0f*2.5, Colors::Crimson, 0.0f, 1.0f);
-			ShowTime("Avarage reaction time: ", GetAverageReactionTime(), TimeDecimals, GAME_WIDTH / 2, 120.0f, Colors::Magenta, 0.0f, 1.0f);
-			ShowTime("Shapes tapped: ", rtv.size(), 0, GAME_WIDTH / 2, 165.0f, Colors::DeepSkyBlue, 0.0f, 1.0f);
-			ShowTime("Credits: ", Credits(), 0, GAME_WIDTH / 2, 210.0f, Colors::Crimson, 0.0f, 1.0f);
-			m_effect->Apply(m_d3dContext.Get());
-			m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-			if (unlock <= 370.0f)
+			DrawButtons(frame.state);
+			ShowTime(hud_fastest, L"Fastest reaction time: ", frame.fastest, TimeDecimals, GAME_WIDTH / 2, 30.0f, Colors::Coral, 0.0f, 1.0f);
+			ShowTime(hud_slowest, L"Slowest reaction time: ", frame.slowest, TimeDecimals, GAME_WIDTH / 2, 30.0f*2.5, Colors::Crimson, 0.0f, 1.0f);
+			ShowTime(hud_average, L"Avarage reaction time: ", frame.average, TimeDecimals, GAME_WIDTH / 2, 120.0f, Colors::Magenta, 0.0f, 1.0f);
+			ShowTime(hud_shapesTapped, L"Shapes tapped: ", frame.shapesTapped, 0, GAME_WIDTH / 2, 165.0f, Colors::DeepSkyBlue, 0.0f, 1.0f);
+			ShowTime(hud_endCredits, L"Credits: ", frame.credits, 0, GAME_WIDTH / 2, 210.0f, Colors::Crimson, 0.0f, 1.0f);
+			ShowTime(hud_p90, L"90th percentile: ", frame.p90, TimeDecimals, GAME_WIDTH / 2 - 150.0f, 245.0f, Colors::Magenta, 0.0f, 0.6f);
+			ShowTime(hud_historyMedian, L"30 day median: ", frame.historyMedian, TimeDecimals, GAME_WIDTH / 2 + 150.0f, 245.0f, Colors::DeepSkyBlue, 0.0f, 0.6f);
+			if (frame.unlock <= 370.0f)
 			{
-					VertexPositionColor v1(Vector2(unlock + 50.0f, 385.0f - 50.0f), Colors::CornflowerBlue);
-					VertexPositionColor v2(Vector2(unlock, 385.0f), Colors::CornflowerBlue);
+					VertexPositionColor v1(Vector2(frame.unlock + 50.0f, 385.0f - 50.0f), Colors::CornflowerBlue);
+					VertexPositionColor v2(Vector2(frame.unlock, 385.0f), Colors::CornflowerBlue);
 					VertexPositionColor v3(Vector2(160.0f, 385.0f), Colors::CornflowerBlue);
 					VertexPositionColor v4(Vector2(160.0f, 385.0f - 50.0f), Colors::CornflowerBlue);
-					m_batch->Begin();
-					m_batch->DrawQuad(v1, v2, v3, v4);
-					m_batch->End();
+					drawList.AddQuad(v1, v2, v3, v4);
 					if (isCursorInsideUnlock())
 						ShowText(L"Drag to unlock", 275.0f, 360.0f, Colors::Black, 0.0f, 0.6f);
 			}
-			else if (unlock > 370.0f)
+			else if (frame.unlock > 370.0f)
 			{
 				VertexPositionColor v1(Vector2(305.0f + 125.0f, 385.0f - 50.0f), Colors::Red);
 				VertexPositionColor v2(Vector2(305.0f + 75.0f, 385.0f), Colors::Red);
 				VertexPositionColor v3(Vector2(160.0f, 385.0f), Colors::Red);
 				VertexPositionColor v4(Vector2(160.0f, 385.0f - 50.0f), Colors::Red);
-				m_batch->Begin();
-				m_batch->DrawQuad(v1, v2, v3, v4);
-				m_batch->End();
-				unlock = 380.0f;
+				drawList.AddQuad(v1, v2, v3, v4);
 				if (isCursorInsideUnlock())
 					ShowText(L"Drag to lock", 275.0f, 360.0f, Colors::Black, 0.0f, 0.6f);
 			}
@@ -1036,20 +1163,40 @@ void Game::Render()
 		default:
 			break;
 	}
+#ifdef _DEBUG
+	// every read used to cost a GetCursorPos and a ScreenToClient
+	ShowTime(hud_cursorReads, L"cursor reads/s: ", frame.cursorReadsPerSecond, 0, 90.0f, 12.0f, Colors::Crimson, 0.0f, 0.4f);
+	ShowTime(hud_cursorSyscalls, L"cursor syscalls/s: ", frame.cursorSyscallsPerSecond, 0, 90.0f, 27.0f, Colors::Crimson, 0.0f, 0.4f);
+	// unchanged frames are skipped, the menus should drop close to zero when nothing moves
+	ShowTime(hud_presents, L"frames presented/s: ", frame.presentsPerSecond, 0, 90.0f, 42.0f, Colors::Crimson, 0.0f, 0.4f);
+	// should read 0, anything else is Render() allocating every frame again
+	ShowTime(hud_renderAllocations, L"render allocations/s: ", frame.renderAllocationsPerSecond, 0, 90.0f, 57.0f, Colors::Crimson, 0.0f, 0.4f);
+	// sessions.bin couldn't be opened or written, the records are kept and tried again every second
+	ShowTime(hud_logFailures, L"session log failures: ", frame.logFailures, 0, 90.0f, 72.0f, Colors::Crimson, 0.0f, 0.4f);
+	ShowTime(hud_logDropped, L"session records lost: ", frame.logDropped, 0, 90.0f, 87.0f, Colors::Crimson, 0.0f, 0.4f);
+	// % of one core spent in this state so far, next to presents/s and the jitter lines it tells
+	// what skipping frames, the tick rates and SIMULATION_THREAD 0 or 1 cost
+	ShowTime(hud_stateCpu, L"cpu % in this state: ", frame.stateCpu, 1, 90.0f, 102.0f, Colors::Crimson, 0.0f, 0.4f);
+	ShowTime(hud_simulationThread, L"simulation thread: ", RunsSimulation() ? 1 : 0, 0, 90.0f, 117.0f, Colors::Crimson, 0.0f, 0.4f);
+#endif // DEBUG
 
+	drawList.Submit(*m_drawBackend);
 	Present();
 }
 
 // Helper method to clear the backbuffers
 void Game::Clear()
 {
+	const Frame& frame = frames.Front();
+	const int randColorEpileptic = frame.randColorEpileptic;
+
 	// Clear the views
-	if (EpilepticMode && GetGameState(state_play) || EpilepticMode && GetGameState(state_playcrazy))
+	if (EpilepticMode && (frame.state == state_play || frame.state == state_playcrazy))
 	{
 		XMVECTORF32 randomColor = { ColorList[randColorEpileptic].r, ColorList[randColorEpileptic].b, ColorList[randColorEpileptic].g, ColorList[randColorEpileptic].a };
 		m_d3dContext->ClearRenderTargetView(m_renderTargetView.Get(), randomColor);
 	}
-	else if (GetGameState(state_null))
+	else if (frame.state == state_null)
 		m_d3dContext->ClearRenderTargetView(m_renderTargetView.Get(), Colors::DarkGray);
 	else
 	    m_d3dContext->ClearRenderTargetView(m_renderTargetView.Get(), Colors::White);
@@ -1064,6 +1211,12 @@ void Game::Present()
 	// to sleep until the next VSync. This ensures we don't waste any cycles rendering
 	// frames that will never be displayed to the screen.
 	HRESULT hr = m_swapChain->Present(0, 0);
+	presents.fetch_add(1, std::memory_order_relaxed);
+
+	// first frame with a new shape, this is when the player can start reacting
+	const Frame& frame = frames.Front();
+	if (SUCCEEDED(hr))
+		stimulusClock.Presented(frame.stimulus, std::chrono::high_resolution_clock::now());
 
 	// If the device was reset we must completely reinitialize the renderer.
 	if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
@@ -1197,6 +1350,9 @@ void Game::CreateDevice()
 	m_batch.reset(new PrimitiveBatch<VertexPositionColor>(m_d3dContext.Get()));
 	m_font.reset(new SpriteFont(m_d3dDevice.Get(), L"Media/myfile.spritefont"));
 	m_spriteBatch.reset(new SpriteBatch(m_d3dContext.Get()));
+	m_drawBackend.reset(new D3DDrawBackend(m_d3dDevice.Get(), m_d3dContext.Get(), m_effect.get(), m_inputLayout.Get(),
+		m_batch.get(), m_spriteBatch.get(), m_font.get()));
+	CreateStaticGeometry();
 }
 
 // Allocate all memory resources that change on a window SizeChanged event.
@@ -1342,6 +1498,7 @@ void Game::CreateResources()
 
 void Game::OnDeviceLost()
 {
+	renderDirty = true;
 	m_depthStencil.Reset();
 	m_depthStencilView.Reset();
 	m_renderTargetView.Reset();
@@ -1351,6 +1508,7 @@ void Game::OnDeviceLost()
 	m_d3dContext.Reset();
 	m_d3dDevice1.Reset();
 	m_d3dDevice.Reset();
+	m_drawBackend.reset();
 	m_effect.reset();
 	m_batch.reset();
 	m_inputLayout.Reset();
@@ -5,20 +5,42 @@
 #include <SimpleMath.h>
 #include <vector>
 #include "audio.h"
+#include "SessionLog.h"
+#include "Statistics.h"
+#include "Histogram.h"
+#include "InputThread.h"
+#include "TripleBuffer.h"
+#include "StimulusClock.h"
+#include "ShapeHitTest.h"
+#include "DrawList.h"
+#include "HudText.h"
+#include "WorkQueue.h"
+#include "Gravity.h"
+#include "GameTags.h"
+#include "ButtonMeshes.h"
 #include <ctime>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #define TimeDecimals 3
-#define maxLines 100
+// the triangles index editor points with 16 bits
+#define maxShapePoints 0xFFFF
+// pixels a closed editor shape may move when its outline gets simplified, 0 keeps every point
+#define shapeTolerance 1.5f
+// most outline points cut into triangles, ear clipping is quadratic and runs under the state lock
+#define maxTriangulatedPoints 256
 
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
 
 class FileHandler;
 
-class Game
+class Game : public GameTags
 {
 public:
+	typedef std::chrono::high_resolution_clock::time_point TimePoint;
 	Game();
 	~Game();
 	FileHandler* fH;
@@ -26,7 +48,14 @@ public:
 	void Initialize(HWND window);
 	// Basic game loop
 	void Tick();
+	double GetSecondsUntilNextUpdate() const { return m_timer.GetSecondsUntilNextUpdate(); }
 	void Render();
+	// With the simulation thread running the main thread only renders, waiting on
+	// FrameReadyEvent() for new frames. Message handlers changing the game state
+	// have to hold StateLock().
+	bool RunsSimulation() const { return simulating; }
+	HANDLE FrameReadyEvent() const { return frameReady; }
+	std::mutex& StateLock() { return stateLock; }
 	// Rendering helpers
 	void Clear();
 	void Present();
@@ -40,32 +69,44 @@ public:
 	void StartScreen();
 	void StartCountdown();
 	void StartGame();
-	void StartTimer();
 	void GenerateShape();
-	void CreateRectangle();
-	void CreateTriangle();
 	bool IsCursorInsideShape();
+	bool IsCursorInsideShape(Vector2 point);
+	bool UsesInputThread() const { return input.IsRunning(); }
+	// taps in play that reach WndProc, pen and touch or every click without the input thread,
+	// handed to ProcessInput() like the input thread's clicks
+	void QueueTap(TimePoint inputTime, float x, float y);
 	bool OnButtonClick();
-	void ShapeTapped();
-	void ShapeMissed();
+	// inputTime is when the click happened, not when it got processed
+	void ShapeTapped(TimePoint inputTime);
+	void ShapeMissed(TimePoint inputTime);
 	void EndGame();
 	int ShapeSize();
 	int Credits();
 	int GameTime();
 	double GetTime();
+	double GetTime(TimePoint eventTime);
 	double GetFastestReactionTime();
 	double GetSlowestReactionTime();
 	double GetAverageReactionTime();
 	double GetReactionTime() { return rtv.back(); }
-	void ShowTime(std::string text, double value, std::streamsize decimals, float x, float y, FXMVECTOR color, float rotation, float scale);
+	// every ShowTime() call site has its own slot, its text is only formatted and measured again when it changes
+	enum HudSlot { hud_countdown, hud_time, hud_reactionTime, hud_shapes, hud_gameTime, hud_shapeSize, hud_credits, hud_lifetimeMedian,
+		hud_fastest, hud_slowest, hud_average, hud_shapesTapped, hud_endCredits, hud_p90, hud_historyMedian, hud_editorPoints,
+		hud_deltaGravity, hud_dropCount, hud_ty, hud_tr, hud_tx, hud_deltaForce, hud_fileOpens, hud_presentDelay, hud_updateJitter,
+		hud_frameJitter, hud_cursorReads, hud_cursorSyscalls, hud_presents, hud_renderAllocations, hud_logFailures,
+		hud_logDropped, hud_stateCpu, hud_simulationThread, hud_max };
+	void ShowTime(HudSlot slot, const wchar_t* text, double value, int decimals, float x, float y, FXMVECTOR color, float rotation, float scale);
 	void ShowText(const wchar_t* widecstr, float x, float y, FXMVECTOR color, float rotation, float scale);
-	enum GameState { state_null, state_suspended, state_startmenu, state_countdown, state_play, state_playcrazy, state_optionsmenu, state_endmenu, state_editor, state_max };
-	enum ShapeTag { shape_triangle, shape_rectangle, shape_max };
-	enum ButtonTag { button_null, button_options, button_start, button_crazy, button_sound, button_shapeSizeUp, button_shapeSizeDown, button_gameTimeUp, button_gameTimeDown, button_editor, button_useOwnShape, button_useGravity, button_epileptic, button_max };
 	bool GetGameState(GameState state, bool last = false);
 	void SetGameState(GameState state);
-	void CreateButton(UINT8 button, XMVECTOR color);
+	static double TargetElapsedSeconds(GameState state);
 	bool IsCursorInsideButton(ButtonTag tag);
+	// the button drawn on the current screen, or the given one, under the cursor
+	ButtonTag ButtonUnderCursor();
+	ButtonTag ButtonUnderCursor(GameState state);
+	bool IsButtonOn(ButtonTag tag);
+	void DrawButtons(GameState state);
 	void ControlSound();
 	bool useOwnShape = false;
 	void Screenshot();
@@ -87,29 +128,118 @@ public:
 	bool buttonDown = false;
 	int ownButtonShape = 0;
 	bool drawShape = false;
-	void CreateOwnShape();
-	Vector2 MousePoint[maxLines];
+	// editor outline, the first point is repeated at the end once the shape is closed
+	std::vector<Vector2> MousePoint;
+	// bounding box of the closed outline, in editor coordinates
+	Vector2 ownShapeMin;
+	Vector2 ownShapeMax;
+	// cut once when the editor closes the shape, three MousePoint indices per triangle
+	std::vector<uint16_t> ownShapeTriangles;
+	ShapeHitTest ownShapeHitTest;
+	void AddOwnShapePoint(Vector2 point);
+	void OnOwnShapeDragged();
+	// false when the outline has no area to tap, a line or a point, and the shape stays open
+	bool OnOwnShapeClosed();
+	void ClearOwnShape();
 	std::vector<VertexPositionColor> vertexXM;
 	Vector2 mPoint();
-	bool checkIfOwnShapeInWindow();
+	// fed from WM_MOUSEMOVE and the button messages, in client coordinates
+	void OnMouseMove(int x, int y);
+	// moves the closed custom shape to a random spot where all of it is in the window
+	void PlaceOwnShape();
 	int randShape = 0;
-	struct Shape { float r = 0.0f; float x = 0.0f; float y = 0.0f; } t, r;
-	float deltaGravity = 0.0f;
-	float dropCount = 1.0f;
-	float deltaForce = 0.0f;
+	typedef ShapePose Shape;
+	Shape t, r;
+	Gravity gravity;
 	bool useGravity = false;
-	bool descending = false;
-	bool ascending = false;
-	bool forceRight = false;
-	bool forceLeft = false;
 	float deltaBounce = 0.0f;
 	int randColorEpileptic = 0;
 	bool EpilepticMode = false;
 	double epilepticTimer = 0.0;
 	bool calculateRandomColors();
 	struct OwnShape { float r = 0.0f; float x = 0.0f; float y = 0.0f; } ownShape;
+	// Everything Render() needs from the simulation, published after every update
+	// everything Render() shows that the simulation owns, add new fields to SameFrame() too
+	struct Frame
+	{
+		uint32_t update = 0;
+		GameState state = state_null;
+		float alphaSplash = 1.0f;
+		double splashScreenTimer = 0.0;
+		int countdown = 0;
+		double gameTime = 0.0;
+		bool missed = false;
+		float missPos = 0.0f;
+		bool tapped = false;
+		float alpha = 1.0f;
+		bool shape = false;
+		float shapePos = 0.0f;
+		int randShape = 0;
+		Shape t, r;
+		OwnShape ownShape;
+		int randColor = 0;
+		int randColorEpileptic = 0;
+		unsigned int stimulus = 0;
+		size_t shapesTapped = 0;
+		double reactionTime = 0.0;
+		double fastest = 0.0;
+		double slowest = 0.0;
+		double average = 0.0;
+		double p90 = 0.0;
+		double historyMedian = 0.0;
+		double lifetimeMedian = 0.0;
+		int credits = 0;
+		int shapeSize = 0;
+		int gameTimeSetting = 0;
+		float unlock = 0.0f;
+		// debug overlay
+		float deltaGravity = 0.0f;
+		float dropCount = 0.0f;
+		float deltaForce = 0.0f;
+		unsigned int fileOpensPerSecond = 0;
+		unsigned int cursorReadsPerSecond = 0;
+		unsigned int cursorSyscallsPerSecond = 0;
+		unsigned int presentsPerSecond = 0;
+		unsigned int renderAllocationsPerSecond = 0;
+		unsigned int logFailures = 0;
+		unsigned int logDropped = 0;
+		double stateCpu = 0.0;
+		double presentDelay = 0.0;
+		double updateJitter = 0.0;
+	};
+	void CreateRectangle(const Frame& frame);
+	void CreateTriangle(const Frame& frame);
+	void CreateOwnShape(const OwnShape& offset, int color);
+	// something Render() shows changed outside the simulation, a click, a resize or a repaint
+	void Invalidate() { renderDirty = true; }
 private:
 	void Update(DX::StepTimer const& timer);
+	void Simulate();
+	void PublishFrame();
+	void StartSimulation();
+	void StopSimulation();
+	void RunSimulation();
+	std::thread simulation;
+	std::atomic<bool> simulating{ false };
+	std::mutex stateLock;
+	HANDLE frameReady = nullptr;
+	TripleBuffer<Frame> frames;
+	// identical frames are neither published nor presented again
+	static bool SameFrame(const Frame& a, const Frame& b);
+	Frame lastPublished;
+	bool renderDirty = true;
+	ButtonTag renderedHover = button_null;
+	bool renderedUnlockHover = false;
+	IntervalJitter updateJitter;
+	IntervalJitter frameJitter;
+	// for the debug overlay, charged on every state change and once a second
+	StateCpuTime<state_max> stateCpu;
+	void ChargeCpu();
+	// when a shape first made it to the screen, handed back from Present() to the simulation
+	StimulusClock stimulusClock;
+	void ProcessInput();
+	InputThread input;
+	SpscQueue<PointerEvent, INPUT_QUEUE_SIZE> windowTaps;
 	bool m_retryAudio;
 	void CreateDevice();
 	void CreateResources();
@@ -118,7 +248,6 @@ private:
 	HWND m_window;
 	RECT rc;
 	// Direct3D Objects
-	DirectX::SimpleMath::Matrix m_world;
 	D3D_FEATURE_LEVEL m_featureLevel;
 	Microsoft::WRL::ComPtr<ID3D11Device> m_d3dDevice;
 	Microsoft::WRL::ComPtr<ID3D11Device1> m_d3dDevice1;
@@ -136,10 +265,24 @@ private:
 	DX::StepTimer m_timer;
 	std::unique_ptr<DirectX::BasicEffect> m_effect;
 	std::unique_ptr<DirectX::PrimitiveBatch<DirectX::VertexPositionColor>> m_batch;
+	// the closed custom shape in editor coordinates and white, moved and coloured per draw
+	std::vector<DirectX::VertexPositionColor> ownShapeVertices;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayout;
 	std::unique_ptr<DirectX::SpriteFont> m_font;
 	DirectX::SimpleMath::Vector2 m_fontPos;
 	std::unique_ptr<DirectX::SpriteBatch> m_spriteBatch;
+	// Render() records into the list, it is drawn in one go right before Present()
+	DrawList drawList;
+	HudText hudText[hud_max];
+	std::unique_ptr<D3DDrawBackend> m_drawBackend;
+	// editor grid, HUD panels and buttons never change, they are uploaded once per device
+	void CreateStaticGeometry();
+	StaticMesh gridMesh = {};
+	StaticMesh hudMesh = {};
+	// the falling shapes in their own space, see ShapeTransform.h
+	StaticMesh triangleMesh = {};
+	StaticMesh rectangleMesh = {};
+	ButtonMeshes buttonMeshes;
 	std::unique_ptr<DirectX::AudioEngine> m_audEngine;
 	std::unique_ptr<DirectX::SoundEffect> m_music;
 	std::unique_ptr<DirectX::SoundEffect> m_right;
@@ -148,13 +291,42 @@ private:
 	std::unique_ptr<DirectX::SoundEffectInstance> m_tapped_i;
 	std::unique_ptr<DirectX::SoundEffectInstance> m_music_i;
 	std::unique_ptr<DirectX::SoundEffectInstance> m_missed_i;
-	std::chrono::time_point<std::chrono::high_resolution_clock> startTimer, endTimer;
 	std::vector<double> rtv;
-	void CountDown(double time);
+	ReactionStats rtStats;
+	Histogram sessionHistogram;
+	Histogram lifetimeHistogram;
+	SessionLog sessionLog;
+	void LogSample(bool hit, double reactionTime);
+	// timestamp of the running session's first record, INT64_MAX before it has one
+	int64_t sessionFirstSample = INT64_MAX;
+	void QueryHistory();
+	// everything end of game writes or reads on disk
+	WorkQueue diskQueue;
+	double historyMedian = 0.0;
+	double lifetimeMedian = 0.0;
 	void CursorClipCheck();
 	float RandomFloat(float min, float max);
 	int randColor = 0;
+	unsigned int fileOpensPerSecond = 0;
+	unsigned int lastFileOpens = 0;
+	// cursor position packed as two int16, written by the window thread
+	std::atomic<uint32_t> cursor{ 0 };
+	void QueryCursor();
+	std::atomic<unsigned int> cursorReads{ 0 };
+	std::atomic<unsigned int> cursorSyscalls{ 0 };
+	unsigned int cursorReadsPerSecond = 0;
+	unsigned int cursorSyscallsPerSecond = 0;
+	unsigned int lastCursorReads = 0;
+	unsigned int lastCursorSyscalls = 0;
+	std::atomic<unsigned int> presents{ 0 };
+	unsigned int presentsPerSecond = 0;
+	unsigned int lastPresents = 0;
+	// counted in debug builds only, see CountRenderAllocations()
+	unsigned int renderAllocationsPerSecond = 0;
+	unsigned int lastRenderAllocations = 0;
+	double fileOpenSampleTime = 0.0;
 	double countdownTime = 0.0;
+	int countdownShown = 0;
 	double gameTime = 0.0;
 	double crazyTimer = 0.0;
 	bool ClickedOnce = false;
@@ -0,0 +1,5 @@
+#pragma once
+
+// size of the game window's client area, everything is laid out in these pixels
+#define GAME_WIDTH 1000
+#define GAME_HEIGHT 600
@@ -0,0 +1,10 @@
+#pragma once
+
+// Screens, shapes and buttons, apart from Game so the button table and what draws it
+// build without the rest of the game
+struct GameTags
+{
+	enum GameState { state_null, state_suspended, state_startmenu, state_countdown, state_play, state_playcrazy, state_optionsmenu, state_endmenu, state_editor, state_max };
+	enum ShapeTag { shape_triangle, shape_rectangle, shape_max };
+	enum ButtonTag { button_null, button_options, button_start, button_crazy, button_sound, button_shapeSizeUp, button_shapeSizeDown, button_gameTimeUp, button_gameTimeDown, button_editor, button_useOwnShape, button_useGravity, button_epileptic, button_back, button_max };
+};
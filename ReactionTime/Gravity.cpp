@@ -0,0 +1,173 @@
+#include "pch.h"
+#include "Gravity.h"
+#include "GameSize.h"
+
+void Gravity::Reset()
+{
+	descending = true;
+	ascending = false;
+	forceRight = false;
+	forceLeft = false;
+	deltaForce = 0.0f;
+	deltaGravity = 0.0f;
+	dropCount = 1;
+	pending = 0.0;
+}
+
+void Gravity::Advance(double elapsed, ShapePose& shape, bool triangle, int shapeSize)
+{
+	pending += elapsed / GRAVITY_STEP;
+	// 1 ms in seconds isn't exact in binary, don't let that drop a step
+	while (pending >= 1.0 - 1e-6)
+	{
+		Step(shape, triangle, shapeSize);
+		pending -= 1.0;
+	}
+	if (pending < 0.0)
+		pending = 0.0;
+}
+
+void Gravity::Bounce(bool right)
+{
+	ascending = true;
+	descending = false;
+	forceRight = right;
+	forceLeft = !right;
+	dropCount = dropCount + 0.4f;
+}
+
+void Gravity::Step(ShapePose& s, bool triangle, int shapeSize)
+{
+	if (descending)
+	{
+		// while descending gravity increases, increasing the speed of the descend
+		deltaGravity += 0.0025f;
+		// max gravity
+		if (deltaGravity < 2.5)
+		{
+			if (triangle)
+			{
+				// increase y to make it drop to the floor and check if it's not outside game boundary
+				if (s.y < GAME_HEIGHT && s.y >= 0.0f)
+					s.y = s.y + deltaGravity;
+				if (s.y + s.r >= GAME_HEIGHT)
+				{
+					// check if shape is not outside game boundary
+					if (s.x - shapeSize + s.r >= 0 || s.x + s.r >= GAME_WIDTH)
+					{
+						// check if shape is rotated to the left
+						if (s.r < shapeSize / 2)
+							s.r -= deltaGravity;
+						// check if shape is rotated to the right
+						else if (s.r > shapeSize / 2)
+							s.r += deltaGravity;
+					}
+					// check if x is not outside left game boundary, otherwise apply right force
+					if (s.x - shapeSize + s.r <= 0)
+						Bounce(true);
+					// check if x is not outside right game boundary, otherwise apply left force
+					else if (s.x - s.r >= GAME_WIDTH)
+						Bounce(false);
+					// check if the rotation is not outside game boundary otherwise make it bounce back
+					if (s.r < 0)
+					{
+						s.r = 0;
+						Bounce(true);
+					}
+					else if (s.r > shapeSize / 1)
+					{
+						s.r = (float)shapeSize / 1;
+						Bounce(false);
+					}
+				}
+			}
+			else
+			{
+				// increase y to make it drop to the floor and check if it's not outside game boundary
+				if (s.y < GAME_HEIGHT && s.y > 0.0f)
+					s.y = s.y + deltaGravity;
+				if (s.y >= GAME_HEIGHT)
+				{
+					if (s.x - shapeSize + s.r >= 0 || s.x + s.r >= GAME_WIDTH)
+					{
+						// check if shape is rotated to the left
+						if (s.r < shapeSize / 2 && s.x - shapeSize >= 0.0f)
+						{
+							s.x -= deltaGravity / dropCount;
+							s.y -= deltaGravity / dropCount;
+							s.r -= deltaGravity / dropCount;
+						}
+						// check if shape is rotated to the right
+						else if (s.r > shapeSize / 2)
+						{
+							s.r += deltaGravity / dropCount;
+							s.x -= deltaGravity / dropCount;
+							s.y -= deltaGravity / dropCount;
+						}
+					}
+					// check if x is not outside left game boundary, otherwise apply right force
+					if (s.x - shapeSize <= 0)
+						Bounce(true);
+					// check if x is not outside right game boundary, otherwise apply left force
+					else if (s.x - s.r >= GAME_WIDTH)
+						Bounce(false);
+					// check if the rotation is not outside game boundary otherwise make it bounce back
+					if (s.r < 0)
+					{
+						s.r = 0;
+						Bounce(true);
+					}
+					else if (s.r > shapeSize / 1)
+					{
+						s.r = (float)shapeSize / 1;
+						Bounce(false);
+					}
+				}
+			}
+		}
+		else
+		{
+			descending = false;
+			ascending = true;
+		}
+	}
+	else if (ascending)
+	{
+		// while ascending gravity decreases, decreasing the speed of the ascend
+		if (deltaGravity > 0.0f)
+		{
+			// decrease y to make it ascend to the ceiling and check if it's not outside game boundary
+			if (s.y < GAME_HEIGHT - s.r && s.y > 0.0f)
+				deltaGravity -= 0.0025f * dropCount;
+			s.y = s.y - deltaGravity;
+			if (s.y <= 0.0f + shapeSize)
+			{
+				ascending = false;
+				descending = true;
+				deltaGravity = 0.0;
+			}
+		}
+		else
+		{
+			descending = true;
+			ascending = false;
+			deltaGravity = 0.0;
+		}
+	}
+	if (forceRight)
+	{
+		deltaForce += ((s.r / 1000) / 100) * deltaGravity;
+		if (s.x < GAME_WIDTH && s.x > 0.0f)
+			if ((deltaForce / dropCount) - 0.025f > 0.0f)
+				s.x = s.x + ((deltaForce / dropCount) - 0.025f);
+	}
+	else if (forceLeft)
+	{
+		deltaForce -= ((s.r / 1000) / 100) * deltaGravity;
+		if (triangle)
+			s.x = s.x - ((deltaForce / dropCount) + 0.02f);
+		else if (s.x < GAME_WIDTH && s.x > 0.0f)
+			if ((deltaForce / dropCount) + 0.025f > 0.0f)
+				s.x = s.x + ((deltaForce / dropCount) + 0.025f);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// the gravity constants are tuned for this step in seconds
+#define GRAVITY_STEP 0.001
+
+// Where a falling shape is, see ShapeTransform.h for how x, y and r place its corners
+struct ShapePose { float r = 0.0f; float x = 0.0f; float y = 0.0f; };
+
+// Drops a shape, lets it bounce off the floor and get pushed sideways.
+// Always integrates in whole GRAVITY_STEPs and carries the rest over to the next Advance(),
+// explicit Euler only gives the same path at every update rate when the step stays the same.
+class Gravity
+{
+public:
+	// starts a new drop
+	void Reset();
+	// moves the shape by the time that passed, triangle selects which of the two shapes it is
+	void Advance(double elapsed, ShapePose& shape, bool triangle, int shapeSize);
+
+	float deltaGravity = 0.0f;
+	float dropCount = 1.0f;
+	float deltaForce = 0.0f;
+	bool descending = false;
+	bool ascending = false;
+	bool forceRight = false;
+	bool forceLeft = false;
+
+private:
+	void Step(ShapePose& s, bool triangle, int shapeSize);
+	// sends the shape back up, pushed to the right or left
+	void Bounce(bool right);
+	// in GRAVITY_STEPs
+	double pending = 0.0;
+};
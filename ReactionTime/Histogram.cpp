@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "Histogram.h"
+#include "FileHandler.h"
+#include <fstream>
+#include <cstring>
+#include <string>
+
+void Histogram::Reset()
+{
+	memset(buckets, 0, sizeof(buckets));
+	count = 0;
+}
+
+int Histogram::BucketOf(uint32_t microseconds)
+{
+	if (microseconds < 2 * HISTOGRAM_SUB_COUNT)
+		return microseconds;
+
+	// shift the value into [SUB_COUNT, 2 * SUB_COUNT), the shift picks the range
+	int shift = 0;
+	while ((microseconds >> shift) >= 2 * HISTOGRAM_SUB_COUNT)
+		shift++;
+	return HISTOGRAM_SUB_COUNT * shift + (microseconds >> shift);
+}
+
+uint32_t Histogram::LowestOf(int bucket)
+{
+	if (bucket < 2 * HISTOGRAM_SUB_COUNT)
+		return bucket;
+
+	int shift = bucket / HISTOGRAM_SUB_COUNT - 1;
+	return (uint32_t)(bucket - HISTOGRAM_SUB_COUNT * shift) << shift;
+}
+
+void Histogram::Record(double seconds)
+{
+	double microseconds = seconds * 1000000.0;
+	if (microseconds < HISTOGRAM_MIN_US)
+		microseconds = HISTOGRAM_MIN_US;
+	else if (microseconds > HISTOGRAM_MAX_US)
+		microseconds = HISTOGRAM_MAX_US;
+
+	buckets[BucketOf((uint32_t)microseconds)]++;
+	count++;
+}
+
+void Histogram::Merge(const Histogram& other)
+{
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		buckets[i] += other.buckets[i];
+	count += other.count;
+}
+
+double Histogram::Percentile(double percentile) const
+{
+	if (count == 0)
+		return 0.0;
+
+	uint64_t rank = (uint64_t)(percentile / 100.0 * count + 0.5);
+	if (rank < 1)
+		rank = 1;
+	if (rank > count)
+		rank = count;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		seen += buckets[i];
+		if (seen >= rank)
+		{
+			// report the middle of the bucket
+			uint32_t lowest = LowestOf(i);
+			uint32_t next = i + 1 < HISTOGRAM_BUCKETS ? LowestOf(i + 1) : lowest + 1;
+			return (lowest + (next - lowest - 1) / 2.0) / 1000000.0;
+		}
+	}
+	return HISTOGRAM_MAX_US / 1000000.0;
+}
+
+bool Histogram::Load(const char* filename)
+{
+	std::ifstream myfile(filename, std::ios::binary);
+	uint32_t magic = 0;
+	uint32_t bucketCount = 0;
+	myfile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	myfile.read(reinterpret_cast<char*>(&bucketCount), sizeof(bucketCount));
+	if (!myfile.good() || magic != HISTOGRAM_MAGIC || bucketCount != HISTOGRAM_BUCKETS)
+		return false;
+
+	Histogram loaded;
+	myfile.read(reinterpret_cast<char*>(loaded.buckets), sizeof(loaded.buckets));
+	if (!myfile.good())
+		return false;
+
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		loaded.count += loaded.buckets[i];
+	*this = loaded;
+	return true;
+}
+
+bool Histogram::Save(const char* filename) const
+{
+	// same temp file and rename dance as the config
+	std::string temp = std::string(filename) + ".tmp";
+	{
+		std::ofstream myfile(temp, std::ios::binary | std::ios::trunc);
+		uint32_t magic = HISTOGRAM_MAGIC;
+		uint32_t bucketCount = HISTOGRAM_BUCKETS;
+		myfile.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+		myfile.write(reinterpret_cast<const char*>(&bucketCount), sizeof(bucketCount));
+		myfile.write(reinterpret_cast<const char*>(buckets), sizeof(buckets));
+		myfile.flush();
+		if (!myfile.good())
+			return false;
+	}
+	return SwapInFile(temp.c_str(), filename);
+}
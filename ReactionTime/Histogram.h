@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+#define HISTOGRAM_FILE "histogram.bin"
+#define HISTOGRAM_MAGIC 0x54534948 // "HIST"
+// recorded range in microseconds, values outside get clamped
+#define HISTOGRAM_MIN_US 50
+#define HISTOGRAM_MAX_US 10000000
+// linear sub-buckets per power of two, 1/128 relative precision
+#define HISTOGRAM_SUB_BITS 7
+#define HISTOGRAM_SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+// values below 2 * HISTOGRAM_SUB_COUNT are exact, 16 log-linear ranges above
+// cover everything up to HISTOGRAM_MAX_US
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_COUNT * 18)
+
+// Log-bucketed reaction time histogram in the spirit of HdrHistogram: O(1)
+// Record(), fixed memory and O(buckets) merging, so a lifetime of samples can
+// be kept next to the config without growing.
+class Histogram
+{
+public:
+	Histogram() { Reset(); }
+	void Reset();
+	void Record(double seconds);
+	void Merge(const Histogram& other);
+	uint64_t Count() const { return count; }
+	// Value at the given percentile (0-100) in seconds
+	double Percentile(double percentile) const;
+	bool Load(const char* filename = HISTOGRAM_FILE);
+	bool Save(const char* filename = HISTOGRAM_FILE) const;
+	static int BucketOf(uint32_t microseconds);
+	static uint32_t LowestOf(int bucket);
+private:
+	uint64_t buckets[HISTOGRAM_BUCKETS];
+	uint64_t count;
+};
@@ -0,0 +1,165 @@
+#include "pch.h"
+#include "History.h"
+#include <algorithm>
+#include <fstream>
+
+bool History::Open(const char* logFile, const char* indexFile)
+{
+	Close();
+	if (!log.Open(logFile))
+		return false;
+	this->indexFile = indexFile;
+
+	LoadIndex();
+
+	// summarize complete blocks the index file doesn't know about yet
+	size_t completeBlocks = log.Count() / HISTORY_BLOCK_SIZE;
+	if (indexedBlocks > completeBlocks || (indexedBlocks > 0 &&
+		blocks[indexedBlocks - 1].last != BuildBlock((indexedBlocks - 1) * HISTORY_BLOCK_SIZE, indexedBlocks * HISTORY_BLOCK_SIZE).last))
+	{
+		// the index belongs to a different log, start over
+		blocks.clear();
+		indexedBlocks = 0;
+	}
+	for (size_t i = indexedBlocks; i < completeBlocks; i++)
+		blocks.push_back(BuildBlock(i * HISTORY_BLOCK_SIZE, (i + 1) * HISTORY_BLOCK_SIZE));
+	if (completeBlocks != indexedBlocks)
+	{
+		indexedBlocks = completeBlocks;
+		SaveIndex();
+	}
+
+	// the trailing partial block is never stored
+	if (log.Count() % HISTORY_BLOCK_SIZE != 0)
+		blocks.push_back(BuildBlock(completeBlocks * HISTORY_BLOCK_SIZE, log.Count()));
+	return true;
+}
+
+void History::Close()
+{
+	log.Close();
+	blocks.clear();
+	indexedBlocks = 0;
+}
+
+History::Block History::BuildBlock(size_t begin, size_t end) const
+{
+	Block block = { log[begin].timestamp, log[begin].timestamp, 0 };
+	for (size_t i = begin; i < end; i++)
+	{
+		block.first = std::min(block.first, log[i].timestamp);
+		block.last = std::max(block.last, log[i].timestamp);
+		block.modes |= 1 << ModeOf(log[i].flags);
+	}
+	return block;
+}
+
+bool History::Matches(const Block& block, const HistoryQuery& query) const
+{
+	if (block.last < query.from || block.first >= query.to)
+		return false;
+
+	// skip the block when none of its modes can satisfy the mode part of the query
+	uint8_t modeMask = ModeOf(query.flagMask);
+	uint8_t modeValue = ModeOf(query.flagValue);
+	for (uint8_t mode = 0; mode < HISTORY_MODES; mode++)
+	{
+		if ((block.modes & (1 << mode)) && (mode & modeMask) == modeValue)
+			return true;
+	}
+	return false;
+}
+
+void History::Collect(const HistoryQuery& query, std::vector<float>& values) const
+{
+	// blocks are in time order, jump straight to the first one that can overlap
+	auto it = std::lower_bound(blocks.begin(), blocks.end(), query.from,
+		[](const Block& block, int64_t from) { return block.last < from; });
+
+	for (; it != blocks.end() && it->first < query.to; ++it)
+	{
+		if (!Matches(*it, query))
+			continue;
+
+		size_t begin = (it - blocks.begin()) * HISTORY_BLOCK_SIZE;
+		size_t end = std::min(begin + HISTORY_BLOCK_SIZE, log.Count());
+		for (size_t i = begin; i < end; i++)
+		{
+			const SessionRecord& record = log[i];
+			if (record.timestamp >= query.from && record.timestamp < query.to &&
+				(record.flags & query.flagMask) == query.flagValue)
+				values.push_back(record.reactionTime);
+		}
+	}
+}
+
+HistoryStats History::Aggregate(const HistoryQuery& query) const
+{
+	std::vector<float> values;
+	Collect(query, values);
+	return Summarize(values);
+}
+
+HistoryStats History::Summarize(std::vector<float>& values)
+{
+	HistoryStats stats;
+	if (values.empty())
+		return stats;
+
+	double sum = 0.0;
+	stats.min = values[0];
+	stats.max = values[0];
+	for (float value : values)
+	{
+		sum += value;
+		stats.min = std::min(stats.min, (double)value);
+		stats.max = std::max(stats.max, (double)value);
+	}
+	stats.count = values.size();
+	stats.mean = sum / values.size();
+
+	auto middle = values.begin() + values.size() / 2;
+	std::nth_element(values.begin(), middle, values.end());
+	stats.median = *middle;
+	return stats;
+}
+
+void History::LoadIndex()
+{
+	blocks.clear();
+	indexedBlocks = 0;
+
+	std::ifstream myfile(indexFile, std::ios::binary | std::ios::ate);
+	const std::streamoff size = myfile.tellg();
+	myfile.seekg(0);
+	uint32_t magic = 0;
+	uint64_t count = 0;
+	myfile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	myfile.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!myfile.good() || magic != HISTORY_INDEX_MAGIC)
+		return;
+
+	// trust the count only as far as the file and the log back it up, Open() rebuilds otherwise
+	const uint64_t headerSize = sizeof(magic) + sizeof(count);
+	if (count > log.Count() / HISTORY_BLOCK_SIZE || (uint64_t)size != headerSize + count * sizeof(Block))
+		return;
+
+	blocks.resize((size_t)count);
+	myfile.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(Block));
+	if (!myfile.good())
+	{
+		blocks.clear();
+		return;
+	}
+	indexedBlocks = blocks.size();
+}
+
+void History::SaveIndex() const
+{
+	std::ofstream myfile(indexFile, std::ios::binary | std::ios::trunc);
+	uint32_t magic = HISTORY_INDEX_MAGIC;
+	uint64_t count = indexedBlocks;
+	myfile.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+	myfile.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	myfile.write(reinterpret_cast<const char*>(blocks.data()), indexedBlocks * sizeof(Block));
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "SessionLog.h"
+
+#define HISTORY_INDEX_FILE "sessions.idx"
+#define HISTORY_INDEX_MAGIC 0x58444952 // "RIDX"
+// records summarized by one index entry
+#define HISTORY_BLOCK_SIZE 4096
+// crazy, gravity, epileptic and own shape flags give 16 possible modes
+#define HISTORY_MODES 16
+
+// Which samples a query looks at: [from, to) in SessionRecord::timestamp units,
+// and only records where (flags & flagMask) == flagValue
+struct HistoryQuery
+{
+	int64_t from = INT64_MIN;
+	int64_t to = INT64_MAX;
+	uint8_t flagMask = session_hit;
+	uint8_t flagValue = session_hit;
+};
+
+struct HistoryStats
+{
+	size_t count = 0;
+	double min = 0.0;
+	double max = 0.0;
+	double mean = 0.0;
+	double median = 0.0;
+};
+
+// Query layer on top of the memory mapped session log. Records are appended in
+// time order, so a sparse per-block index (time range and the set of modes seen
+// in the block) is enough to skip everything outside a query without touching
+// the mapped pages. The index is kept in sessions.idx and extended on Open().
+class History
+{
+public:
+	bool Open(const char* logFile = SESSION_LOG_FILE, const char* indexFile = HISTORY_INDEX_FILE);
+	void Close();
+	size_t Count() const { return log.Count(); }
+	// Appends the reaction time of every matching record to values
+	void Collect(const HistoryQuery& query, std::vector<float>& values) const;
+	HistoryStats Aggregate(const HistoryQuery& query) const;
+	static uint8_t ModeOf(uint8_t flags) { return (flags >> 1) & (HISTORY_MODES - 1); }
+	static HistoryStats Summarize(std::vector<float>& values);
+private:
+	struct Block
+	{
+		int64_t first;
+		int64_t last;
+		uint16_t modes; // bit per ModeOf() value present in the block
+	};
+	Block BuildBlock(size_t begin, size_t end) const;
+	bool Matches(const Block& block, const HistoryQuery& query) const;
+	void LoadIndex();
+	void SaveIndex() const;
+	SessionLogReader log;
+	std::string indexFile;
+	std::vector<Block> blocks;
+	size_t indexedBlocks = 0;
+};
@@ -0,0 +1,19 @@
+#include "pch.h"
+#include "HudText.h"
+#include <cmath>
+
+bool HudText::Set(const wchar_t* label, double value, int decimals)
+{
+	decimals = decimals < 0 ? 0 : (decimals > HUD_MAX_DECIMALS ? HUD_MAX_DECIMALS : decimals);
+	const double shown = RoundFixed(value, decimals);
+	// nan never equals itself, two of them show the same text, 0 and -0 don't
+	if (label == this->label && decimals == this->decimals &&
+		((shown == this->shown && std::signbit(shown) == std::signbit(this->shown)) || (shown != shown && this->shown != this->shown)))
+		return false;
+
+	this->label = label;
+	this->decimals = decimals;
+	this->shown = shown;
+	FormatFixed(text, HUD_TEXT_LENGTH, label, value, decimals);
+	return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FormatFixed.h"
+
+// longest HUD line, label included, longer ones get cut
+#define HUD_TEXT_LENGTH 64
+
+// One HUD line. The text is only formatted again, and the caller only has to measure it
+// again, when the value changes at the precision it is shown with.
+class HudText
+{
+public:
+	// returns true when the text changed
+	bool Set(const wchar_t* label, double value, int decimals);
+	const wchar_t* Text() const { return text; }
+	// half the measured size of Text(), kept for the caller
+	DirectX::XMFLOAT2 origin;
+
+private:
+	wchar_t text[HUD_TEXT_LENGTH];
+	const wchar_t* label = nullptr;
+	int decimals = -1;
+	// RoundFixed() of the value as it was shown last
+	double shown = 0.0;
+};
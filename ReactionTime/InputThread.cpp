@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "InputThread.h"
+#include "GameSize.h"
+#include <future>
+
+// HID usage of a mouse, for RegisterRawInputDevices
+#define HID_USAGE_PAGE_GENERIC 0x01
+#define HID_USAGE_GENERIC_MOUSE 0x02
+
+bool InputThread::Start(HWND window)
+{
+	if (running)
+		return true;
+
+	gameWindow = window;
+
+	// wait until the thread either owns a raw input window or gave up
+	std::promise<bool> started;
+	std::future<bool> result = started.get_future();
+	thread = std::thread([this, &started]()
+	{
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+		WNDCLASSEX wcex = { 0 };
+		wcex.cbSize = sizeof(WNDCLASSEX);
+		wcex.lpfnWndProc = InputThread::WndProc;
+		wcex.hInstance = GetModuleHandle(nullptr);
+		wcex.lpszClassName = L"ReactionTimeInputClass";
+		RegisterClassEx(&wcex);
+
+		inputWindow = CreateWindowEx(0, L"ReactionTimeInputClass", nullptr, 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, wcex.hInstance, nullptr);
+		if (!inputWindow)
+		{
+			started.set_value(false);
+			return;
+		}
+		SetWindowLongPtr(inputWindow, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+
+		// INPUTSINK delivers mouse input to this window while the game window has focus
+		RAWINPUTDEVICE device;
+		device.usUsagePage = HID_USAGE_PAGE_GENERIC;
+		device.usUsage = HID_USAGE_GENERIC_MOUSE;
+		device.dwFlags = RIDEV_INPUTSINK;
+		device.hwndTarget = inputWindow;
+		if (!RegisterRawInputDevices(&device, 1, sizeof(device)))
+		{
+			DestroyWindow(inputWindow);
+			inputWindow = nullptr;
+			started.set_value(false);
+			return;
+		}
+
+		running = true;
+		started.set_value(true);
+		Run();
+	});
+
+	if (!result.get())
+	{
+		thread.join();
+		return false;
+	}
+	return true;
+}
+
+void InputThread::Stop()
+{
+	if (!thread.joinable())
+		return;
+
+	if (inputWindow)
+		PostMessage(inputWindow, WM_CLOSE, 0, 0);
+	thread.join();
+	running = false;
+}
+
+void InputThread::Run()
+{
+	MSG msg = { 0 };
+	while (GetMessage(&msg, nullptr, 0, 0) > 0)
+	{
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+
+	RAWINPUTDEVICE device;
+	device.usUsagePage = HID_USAGE_PAGE_GENERIC;
+	device.usUsage = HID_USAGE_GENERIC_MOUSE;
+	device.dwFlags = RIDEV_REMOVE;
+	device.hwndTarget = nullptr;
+	RegisterRawInputDevices(&device, 1, sizeof(device));
+	inputWindow = nullptr;
+}
+
+LRESULT CALLBACK InputThread::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	auto input = reinterpret_cast<InputThread*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+
+	switch (message)
+	{
+	case WM_INPUT:
+		if (input)
+			input->OnRawInput(reinterpret_cast<HRAWINPUT>(lParam));
+		break;
+	case WM_CLOSE:
+		DestroyWindow(hWnd);
+		return 0;
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		return 0;
+	}
+	return DefWindowProc(hWnd, message, wParam, lParam);
+}
+
+void InputThread::OnRawInput(HRAWINPUT rawInput)
+{
+	// timestamp first, everything after this is processing time
+	auto time = std::chrono::high_resolution_clock::now();
+
+	RAWINPUT raw;
+	UINT size = sizeof(raw);
+	if (GetRawInputData(rawInput, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1)
+		return;
+	if (raw.header.dwType != RIM_TYPEMOUSE || !(raw.data.mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_DOWN))
+		return;
+	// the window procedure times those
+	if ((raw.data.mouse.ulExtraInformation & PEN_TOUCH_SIGNATURE_MASK) == PEN_TOUCH_SIGNATURE)
+		return;
+	if (GetForegroundWindow() != gameWindow)
+		return;
+
+	POINT p;
+	if (!GetCursorPos(&p) || !ScreenToClient(gameWindow, &p))
+		return;
+	if (p.x < 0 || p.y < 0 || p.x >= GAME_WIDTH || p.y >= GAME_HEIGHT)
+		return;
+
+	PointerEvent event = { time, (float)p.x, (float)p.y };
+	// the game loop drains every tick, a full queue means it's stalled anyway
+	events.Push(event);
+}
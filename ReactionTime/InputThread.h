@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "SpscQueue.h"
+
+// pointer events buffered between the input thread and the game loop
+#define INPUT_QUEUE_SIZE 1024
+// extra info of the mouse messages Windows makes up for pen and touch input
+#define PEN_TOUCH_SIGNATURE 0xFF515700
+#define PEN_TOUCH_SIGNATURE_MASK 0xFFFFFF00
+
+struct PointerEvent
+{
+	std::chrono::high_resolution_clock::time_point time;
+	float x; // client coordinates of the game window
+	float y;
+};
+
+// Captures left clicks on a dedicated high priority thread through raw input,
+// timestamps them the moment they arrive and hands them to the game loop
+// through a wait-free queue. Clicks don't wait behind Update() or Render().
+// Only real mice, pen and touch taps still arrive as window messages.
+class InputThread
+{
+public:
+	~InputThread() { Stop(); }
+	bool Start(HWND gameWindow);
+	void Stop();
+	bool IsRunning() const { return running; }
+	// Game loop side
+	bool Pop(PointerEvent& event) { return events.Pop(event); }
+private:
+	void Run();
+	static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+	void OnRawInput(HRAWINPUT rawInput);
+	HWND gameWindow = nullptr;
+	HWND inputWindow = nullptr;
+	std::thread thread;
+	std::atomic<bool> running{ false };
+	SpscQueue<PointerEvent, INPUT_QUEUE_SIZE> events;
+};
@@ -3,7 +3,10 @@
 #include <Dbt.h>
 #include <vector>
 #include "FileHandler.h"
+#include "MessageAge.h"
 #include <windows.h>
+#include <windowsx.h>
+#include <mutex>
 
 using namespace DirectX;
 
@@ -12,12 +15,52 @@ namespace
 	std::unique_ptr<Game> g_game;
 };
 
-namespace
+LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
+
+// How far GetTickCount() jumps at a time in milliseconds, usually 15.6 rounded up
+DWORD TickGranularity()
 {
-	std::unique_ptr<FileHandler> fileHandler;
-};
+	DWORD adjustment, increment;
+	BOOL disabled;
+	if (!GetSystemTimeAdjustment(&adjustment, &increment, &disabled))
+		return 16;
+	// in 100 ns units
+	return (increment + 9999) / 10000;
+}
 
-LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
+// When the message currently being handled was posted, in the reaction timer's clock.
+// GetMessageTime() is in GetTickCount() milliseconds, so only the age of the message
+// is taken from it, see CertainMessageAge(). A reaction is never made faster than it was.
+// Mouse clicks in play get exact times from InputThread.
+Game::TimePoint MessageTime()
+{
+	static const DWORD granularity = TickGranularity();
+	Game::TimePoint now = std::chrono::high_resolution_clock::now();
+	return now - std::chrono::milliseconds(CertainMessageAge(GetTickCount(), static_cast<DWORD>(GetMessageTime()), granularity));
+}
+
+// Whether the current mouse message was made up from a pen or touch tap, InputThread only sees mice
+bool FromPenOrTouch()
+{
+	return (GetMessageExtraInfo() & PEN_TOUCH_SIGNATURE_MASK) == PEN_TOUCH_SIGNATURE;
+}
+
+// Messages whose handlers change state the simulation thread works on
+bool ChangesGameState(UINT message)
+{
+	switch (message)
+	{
+	case WM_LBUTTONDOWN:
+	case WM_LBUTTONUP:
+	case WM_SIZE:
+	case WM_ACTIVATEAPP:
+	case WM_POWERBROADCAST:
+	case WM_DEVICECHANGE:
+		return true;
+	default:
+		return false;
+	}
+}
 
 void ClientResize(HWND hWnd, int nWidth, int nHeight)
 {
@@ -95,6 +138,15 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 			DEVICE_NOTIFY_WINDOW_HANDLE);
 	}
 
+	// Waitable timer to sleep until the next update is due instead of spinning
+	bool highResolutionTimer = true;
+	HANDLE waitTimer = CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (!waitTimer)
+	{
+		highResolutionTimer = false;
+		waitTimer = CreateWaitableTimerEx(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	}
+
 	// Main message loop
 	MSG msg = { 0 };
 	while (WM_QUIT != msg.message)
@@ -106,13 +158,43 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 		}
 		else
 		{
+			// the simulation thread signals every frame that changed, messages can change
+			// what is shown as well, Render() skips itself when neither did
+			if (g_game->RunsSimulation())
+			{
+				g_game->Render();
+				HANDLE frameReady = g_game->FrameReadyEvent();
+				MsgWaitForMultipleObjects(1, &frameReady, FALSE, INFINITE, QS_ALLINPUT);
+				continue;
+			}
+
 			if (g_game->GetGameState(g_game->state_suspended))
+			{
 				Sleep(1);
-			else
-				g_game->Tick();
+				continue;
+			}
+
+			// a low resolution timer can't hit sub-tick waits, spin for those
+			double wait = g_game->GetSecondsUntilNextUpdate();
+			if (waitTimer && wait > 0.0 && (highResolutionTimer || wait > 0.002))
+			{
+				// negative due time is relative, in 100 ns units
+				LARGE_INTEGER dueTime;
+				dueTime.QuadPart = -static_cast<LONGLONG>(wait * 10000000.0);
+				if (SetWaitableTimer(waitTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+				{
+					// wake up early for any input so nothing waits behind the sleep
+					MsgWaitForMultipleObjects(1, &waitTimer, FALSE, INFINITE, QS_ALLINPUT);
+					continue;
+				}
+			}
+			g_game->Tick();
 		}
 	}
 
+	if (waitTimer)
+		CloseHandle(waitTimer);
+
 	g_game.reset();
 
 	if (hNewAudio)
@@ -135,11 +217,36 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
 	auto game = reinterpret_cast<Game*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
 
+	// the simulation thread may be in the middle of an update, wait for it. Only held for
+	// the handlers below: DefWindowProc() and resizing can send this window messages that
+	// would lock the same mutex again on this thread.
+	std::unique_lock<std::mutex> lock;
+	if (game && game->RunsSimulation() && ChangesGameState(message))
+		lock = std::unique_lock<std::mutex>(game->StateLock());
+	if (game && ChangesGameState(message))
+		game->Invalidate();
+
 	switch (message)
 	{
 	case WM_TOUCH:
 		break;
+	case WM_MOUSEMOVE:
+		if (game)
+		{
+			game->OnMouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+			// only dragging can change the editor shape, plain moves skip the lock
+			if (game->buttonDown)
+			{
+				if (game->RunsSimulation())
+					lock = std::unique_lock<std::mutex>(game->StateLock());
+				game->OnOwnShapeDragged();
+				game->Invalidate();
+			}
+		}
+		break;
 	case WM_PAINT:
+		if (game)
+			game->Invalidate();
 		hdc = BeginPaint(hWnd, &ps);
 		EndPaint(hWnd, &ps);
 		break;
@@ -148,166 +255,140 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			game->Screenshot();
 		break;
 	case WM_LBUTTONUP:
+	{
+		game->OnMouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
 		game->buttonDown = false;
+		const Game::ButtonTag button = game->ButtonUnderCursor();
 		// Sound button
 		if (game->GetGameState(game->state_optionsmenu) || game->GetGameState(game->state_startmenu))
 		{
-			if (game->IsCursorInsideButton(game->button_sound))
+			if (button == game->button_sound)
 				game->ControlSound();
 		}
 		// Options Menu: shape size up and down, game time down and up
 		if (game->GetGameState(game->state_optionsmenu))
 		{
-			if (game->IsCursorInsideButton(game->button_useOwnShape))
+			if (button == game->button_useOwnShape)
 				game->useOwnShape = !game->useOwnShape;
-			else if (game->IsCursorInsideButton(game->button_epileptic))
+			else if (button == game->button_epileptic)
 				game->EpilepticMode = !game->EpilepticMode;
-			else if (game->IsCursorInsideButton(game->button_useGravity))
+			else if (button == game->button_useGravity)
 				game->useGravity = !game->useGravity;
-			else if (game->IsCursorInsideButton(game->button_shapeSizeUp))
+			else if (button == game->button_shapeSizeUp)
 			{
 				if (GetKeyState(VK_SHIFT) & 0x8000)
 				{
 					if (game->ShapeSize() + 10 <= SHAPE_SIZE_MAX && game->Credits() - 10 >= 0)
-						fileHandler->WriteConfig(game->Credits() - 10, game->ShapeSize() + 10, game->GameTime());
+						game->fH->SetConfig(game->Credits() - 10, game->ShapeSize() + 10, game->GameTime());
 				}
 				else
 				{
 					if (game->ShapeSize() + 1 <= SHAPE_SIZE_MAX && game->Credits() - 1 >= 0)
-						fileHandler->WriteConfig(game->Credits() - 1, game->ShapeSize() + 1, game->GameTime());
+						game->fH->SetConfig(game->Credits() - 1, game->ShapeSize() + 1, game->GameTime());
 				}
 			}
-			else if (game->IsCursorInsideButton(game->button_shapeSizeDown))
+			else if (button == game->button_shapeSizeDown)
 			{
 				if (GetKeyState(VK_SHIFT) & 0x8000)
 				{
 					if (game->ShapeSize() - 10 > 0 && game->Credits() - 10 >= 0)
-						fileHandler->WriteConfig(game->Credits() - 10, game->ShapeSize() - 10, game->GameTime());
+						game->fH->SetConfig(game->Credits() - 10, game->ShapeSize() - 10, game->GameTime());
 				}
 				else
 				{
 					if (game->ShapeSize() - 1 > 0 && game->Credits() - 1 >= 0)
-						fileHandler->WriteConfig(game->Credits() - 1, game->ShapeSize() - 1, game->GameTime());
+						game->fH->SetConfig(game->Credits() - 1, game->ShapeSize() - 1, game->GameTime());
 				}
 			}
-			else if (game->IsCursorInsideButton(game->button_gameTimeUp))
+			else if (button == game->button_gameTimeUp)
 			{
 				if (game->GameTime() + 1 <= GAME_TIME_MAX && game->Credits() - 1 >= 0)
-					fileHandler->WriteConfig(game->Credits() - 1, game->ShapeSize(), game->GameTime() + 1);
+					game->fH->SetConfig(game->Credits() - 1, game->ShapeSize(), game->GameTime() + 1);
 			}
-			else if (game->IsCursorInsideButton(game->button_gameTimeDown))
+			else if (button == game->button_gameTimeDown)
 			{
 				if (game->GameTime() - 1 > 0 && game->Credits() - 1 >= 0)
-					fileHandler->WriteConfig(game->Credits() - 1, game->ShapeSize(), game->GameTime() - 1);
+					game->fH->SetConfig(game->Credits() - 1, game->ShapeSize(), game->GameTime() - 1);
 			}
+			game->fH->SetOptions(game->useGravity, game->EpilepticMode, game->useOwnShape);
+			game->fH->ScheduleSave();
 		}
-		break;
+	}
+	break;
 	case WM_LBUTTONDOWN:
+	{
+		game->OnMouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
 		game->buttonDown = true;
+		const Game::ButtonTag button = game->ButtonUnderCursor();
 		if (game->GetGameState(game->state_endmenu) && game->unlock < 380.0f)
 			return 0;
 		if (game->GetGameState(game->state_play) || game->GetGameState(game->state_playcrazy))
 		{
-			if (game->IsCursorInsideShape())
-				game->ShapeTapped();
-			else
-				game->ShapeMissed();
+			// with the input thread running mouse clicks reach the game through Game::ProcessInput,
+			// the rest is queued there too so only the simulation judges and times taps
+			if (!game->UsesInputThread() || FromPenOrTouch())
+			{
+				const Vector2 point = game->mPoint();
+				game->QueueTap(MessageTime(), point.x, point.y);
+			}
 		}
 		else if (game->GetGameState(game->state_editor))
 		{
-			if (game->IsCursorInsideButton(game->button_options))
+			if (button == game->button_back)
 			{
 				game->SetGameState(game->state_optionsmenu);
 				return 0;
 			}
 			if (game->drawShape)
 			{
-				std::vector<VertexPositionColor>().swap(game->vertexXM);
-				for (int i = 0; i < maxLines; i++)
-				{
-					game->MousePoint[i] = Vector2(0.0f, 0.0f);
-				}
-				game->ownButtonShape = 0;
-				game->drawShape = false;
+				game->ClearOwnShape();
 				return 0;
 			}
-			else if (!game->drawShape && game->ownButtonShape > 2 && game->ownButtonShape < 100)
-			{
-				if (game->mPoint().x < game->MousePoint[0].x + 10.0f && game->mPoint().x > game->MousePoint[0].x - 10.0f &&
-					game->mPoint().y < game->MousePoint[0].y + 10.0f && game->mPoint().y > game->MousePoint[0].y - 10.0f)
-				{
-					game->MousePoint[game->ownButtonShape] = game->MousePoint[0];
-					for (int i = 0; i < maxLines; i++)
-					{
-						game->vertexXM.push_back(VertexPositionColor(Vector2(game->MousePoint[i].x, game->MousePoint[i].y), Colors::Red));
-					}
-					game->drawShape = true;
-					return 0;
-				}
-				game->MousePoint[game->ownButtonShape] = game->mPoint();
-				game->vertexXM.push_back(VertexPositionColor(Vector2(game->MousePoint[game->ownButtonShape].x, game->MousePoint[game->ownButtonShape].y), Colors::Red));
-				game->ownButtonShape++;
-			}
-			// last mouse
-			//  [0] [0]
-			switch (game->ownButtonShape)
+			const Vector2 point = game->mPoint();
+			// clicking next to the first point closes the shape
+			if (game->ownButtonShape > 2 &&
+				point.x < game->MousePoint[0].x + 10.0f && point.x > game->MousePoint[0].x - 10.0f &&
+				point.y < game->MousePoint[0].y + 10.0f && point.y > game->MousePoint[0].y - 10.0f)
 			{
-			case 0: // first point
-				game->MousePoint[0] = game->mPoint();
-				game->vertexXM.push_back(VertexPositionColor(Vector2(game->MousePoint[0].x, game->MousePoint[0].y), Colors::Red));
-				game->ownButtonShape++;
-				break;
-			case 1: // second point
-				game->MousePoint[1] = game->mPoint();
-				game->vertexXM.push_back(VertexPositionColor(Vector2(game->MousePoint[1].x, game->MousePoint[1].y), Colors::Red));
-				game->ownButtonShape++;
-				break;
-			case 2: // third point
-				game->MousePoint[2] = game->mPoint();
-				game->vertexXM.push_back(VertexPositionColor(Vector2(game->MousePoint[2].x, game->MousePoint[2].y), Colors::Red));
-				game->ownButtonShape++;
-				break;
-			case 99: // Max point
-				game->MousePoint[game->ownButtonShape] = game->MousePoint[0];
-				game->vertexXM.push_back(VertexPositionColor(Vector2(game->MousePoint[game->ownButtonShape].x, game->MousePoint[game->ownButtonShape].y), Colors::Red));
-				game->drawShape = true;
+				game->OnOwnShapeClosed();
 				return 0;
-				break;
 			}
+			game->AddOwnShapePoint(point);
 		}
 		// Start Menu or End Menu: start, crazy or options
 		else if (game->GetGameState(game->state_startmenu) || game->GetGameState(game->state_endmenu))
 		{
-			if (game->IsCursorInsideButton(game->button_start))
+			if (button == game->button_start)
 			{
 				game->StartCountdown();
 				game->crazyGame = false;
 			}
-			else if (game->IsCursorInsideButton(game->button_crazy))
+			else if (button == game->button_crazy)
 			{
 				game->StartCountdown();
 				game->crazyGame = true;
 			}
-			else if (game->IsCursorInsideButton(game->button_options))
+			else if (button == game->button_options)
 				game->SetGameState(game->state_optionsmenu);
-			if (game->IsCursorInsideButton(game->button_editor))
+			if (button == game->button_editor)
 				game->SetGameState(game->state_editor);
 		}
-		// End Menu: options
+		// Options Menu opened from the End Menu: back
 		else if (game->GetGameState(game->state_endmenu, true))
 		{
-			if (game->IsCursorInsideButton(game->button_options))
+			if (button == game->button_back)
 				game->SetGameState(game->state_endmenu);
 		}
 		// Options Menu: back (to end menu)
 		else if (game->GetGameState(game->state_optionsmenu))
 		{
-			if (game->IsCursorInsideButton(game->button_options))
+			if (button == game->button_back)
 				game->SetGameState(game->state_startmenu);
 		}
 		else if (game->GetGameState(game->state_null))
 			game->SetGameState(game->state_startmenu);
-		break;
+	}
+	break;
 	case WM_SIZE:
 		if (wParam == SIZE_MINIMIZED)
 		{
@@ -327,7 +408,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			s_in_suspend = false;
 		}
 		else if (!s_in_sizemove && game)
+		{
+			if (lock.owns_lock())
+				lock.unlock();
 			game->OnWindowSizeChanged();
+		}
 		break;
 	case WM_ENTERSIZEMOVE:
 		s_in_sizemove = true;
@@ -395,5 +480,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		return 0;
 	}
 
+	if (lock.owns_lock())
+		lock.unlock();
 	return DefWindowProc(hWnd, message, wParam, lParam);
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+// window messages older than this in milliseconds weren't held up in the queue, they were sent late
+#define MAX_MESSAGE_AGE 1000
+
+// How long ago a window message was posted, as far as two GetTickCount() reads can prove it,
+// in milliseconds. Each read is up to one granularity behind, so an age within a tick is noise
+// and longer ones are cut by a tick: the message is never made out to be older than it is,
+// and the true age is less than two granularities more. Wraps around with the tick count.
+inline uint32_t CertainMessageAge(uint32_t tickNow, uint32_t messageTick, uint32_t granularity)
+{
+	const uint32_t age = tickNow - messageTick;
+	if (age <= granularity || age > MAX_MESSAGE_AGE)
+		return 0;
+	return age - granularity;
+}
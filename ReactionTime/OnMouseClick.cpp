@@ -2,46 +2,34 @@
 #include "Game.h"
 #include "Buttons.h"
 #include "FileHandler.h"
+#include "Triangulate.h"
+#include "ShapeTransform.h"
 
 using namespace DirectX::SimpleMath;
 
-float calculateSign(Vector2 mPoint, Vector2 v1, Vector2 v2)
+// Last cursor position the window got a mouse message for, no system calls
+Vector2 Game::mPoint()
 {
-	return (mPoint.x - v2.x) * (v1.y - v2.y) - (v1.x - v2.x) * (mPoint.y - v2.y);
+	cursorReads.fetch_add(1, std::memory_order_relaxed);
+	const uint32_t packed = cursor.load(std::memory_order_relaxed);
+	return Vector2((float)(int16_t)(packed & 0xFFFF), (float)(int16_t)(packed >> 16));
 }
 
-bool isCursorInsideTriangle(Vector2 mPoint, Vector2 v1, Vector2 v2, Vector2 v3)
+void Game::OnMouseMove(int x, int y)
 {
-	bool b1, b2, b3;
-
-	b1 = calculateSign(mPoint, v1, v2) < 0.0f;
-	b2 = calculateSign(mPoint, v2, v3) < 0.0f;
-	b3 = calculateSign(mPoint, v3, v1) < 0.0f;
-
-	return ((b1 == b2) && (b2 == b3));
+	cursor.store((uint32_t)(uint16_t)x | (uint32_t)(uint16_t)y << 16, std::memory_order_relaxed);
 }
 
-bool isCursorInsideRectangle(Vector2 mPoint, Vector2 v1, Vector2 v2, Vector2 v3, Vector2 v4)
-{
-	bool b1, b2, b3, b4;
-
-	b1 = calculateSign(mPoint, v1, v2) < 0.0f;
-	b2 = calculateSign(mPoint, v2, v3) < 0.0f;
-	b3 = calculateSign(mPoint, v3, v4) < 0.0f;
-	b4 = calculateSign(mPoint, v4, v1) < 0.0f;
-
-	return ((b1 == b2) && (b2 == b3) && (b3 == b4));
-}
-
-Vector2 Game::mPoint()
+// Asks Windows where the cursor is, only needed before the first mouse message
+void Game::QueryCursor()
 {
 	POINT p;
-	if (GetCursorPos(&p))
-	{
-		if (ScreenToClient(m_window, &p))
-			return Vector2((float)p.x, (float)p.y);
-	}
-	return Vector2(0.0f, 0.0f);
+	cursorSyscalls.fetch_add(1, std::memory_order_relaxed);
+	if (!GetCursorPos(&p))
+		return;
+	cursorSyscalls.fetch_add(1, std::memory_order_relaxed);
+	if (ScreenToClient(m_window, &p))
+		OnMouseMove(p.x, p.y);
 }
 
 bool Game::isCursorInsideUnlock()
@@ -56,6 +44,11 @@ bool Game::isCursorInsideUnlock()
 }
 
 bool Game::IsCursorInsideShape()
+{
+	return IsCursorInsideShape(mPoint());
+}
+
+bool Game::IsCursorInsideShape(Vector2 point)
 {
 	if (!useOwnShape)
 	{
@@ -63,20 +56,22 @@ bool Game::IsCursorInsideShape()
 		{
 		    case shape_triangle:
 		    {
-		    	Vector2 v1(t.x + t.r, t.y - ShapeSize() + t.r);
-		    	Vector2 v2(t.x, t.y + t.r);
-		    	Vector2 v3(t.x - ShapeSize() + t.r, t.y - t.r);
-		    	if (isCursorInsideTriangle(mPoint(), v1, v2, v3))
+		    	const Matrix world = TriangleWorld(t.x, t.y, t.r, (float)ShapeSize());
+		    	Vector2 v1 = Vector2::Transform(TriangleCorners[0], world);
+		    	Vector2 v2 = Vector2::Transform(TriangleCorners[1], world);
+		    	Vector2 v3 = Vector2::Transform(TriangleCorners[2], world);
+		    	if (isCursorInsideTriangle(point, v1, v2, v3))
 		    		return true;
 		    	break;
 		    }
 		    case shape_rectangle:
 		    {
-		    	Vector2 v1(r.x, r.y - ShapeSize() + r.r);
-		    	Vector2 v2(r.x - r.r, r.y);
-		    	Vector2 v3(r.x - ShapeSize(), r.y - r.r);
-		    	Vector2 v4(r.x - ShapeSize() + r.r, r.y - ShapeSize());
-		    	if (isCursorInsideRectangle(mPoint(), v1, v2, v3, v4))
+		    	const Matrix world = RectangleWorld(r.x, r.y, r.r, (float)ShapeSize());
+		    	Vector2 v1 = Vector2::Transform(RectangleCorners[0], world);
+		    	Vector2 v2 = Vector2::Transform(RectangleCorners[1], world);
+		    	Vector2 v3 = Vector2::Transform(RectangleCorners[2], world);
+		    	Vector2 v4 = Vector2::Transform(RectangleCorners[3], world);
+		    	if (isCursorInsideRectangle(point, v1, v2, v3, v4))
 		    		return true;
 		    	break;
 		    }
@@ -84,24 +79,105 @@ bool Game::IsCursorInsideShape()
 	}
 	else
 	{
+		// the triangles are in editor coordinates, move the point instead of the shape
 		if (drawShape)
-		{
-			for (int i = 0; i < ownButtonShape; i++)
-			{
-				Vector2 v1(MousePoint[0].x + ownShape.x, MousePoint[0].y + ownShape.y);
-				Vector2 v2(MousePoint[i + 1].x + ownShape.x, MousePoint[i + 1].y + ownShape.y);
-				Vector2 v3(MousePoint[i + 2].x + ownShape.x, MousePoint[i + 2].y + ownShape.y);
-				if (isCursorInsideTriangle(mPoint(), v1, v2, v3))
-					return true;
-			}
-		}
+			return ownShapeHitTest.Contains(Vector2(point.x - ownShape.x, point.y - ownShape.y));
 	}
 	return false;
 }
 
-bool Game::IsCursorInsideButton(ButtonTag tag)
+// Adds a corner to the editor shape, closing it once no more points fit
+void Game::AddOwnShapePoint(Vector2 point)
+{
+	MousePoint.push_back(point);
+	vertexXM.push_back(VertexPositionColor(point, Colors::Red));
+	ownButtonShape++;
+	if (ownButtonShape == maxShapePoints && !OnOwnShapeClosed())
+		ClearOwnShape();
+}
+
+// Holding the button down in the editor draws freehand, one point per mouse message
+void Game::OnOwnShapeDragged()
+{
+	if (!GetGameState(state_editor) || drawShape || ownButtonShape == 0)
+		return;
+
+	const Vector2 point = mPoint();
+	if (point.x != MousePoint.back().x || point.y != MousePoint.back().y)
+		AddOwnShapePoint(point);
+}
+
+// Simplifies the closed editor shape and cuts it into triangles once, drawing and hit testing both use them
+bool Game::OnOwnShapeClosed()
 {
-	if (isCursorInsideRectangle(mPoint(), ButtonArray[tag][0], ButtonArray[tag][1], ButtonArray[tag][2], ButtonArray[tag][3]))
+	if (!SimplifyAndTriangulate(MousePoint, shapeTolerance, maxTriangulatedPoints, ownShapeTriangles))
+		return false;
+
+	ownButtonShape = static_cast<int>(MousePoint.size());
+	vertexXM.clear();
+	for (int i = 0; i < ownButtonShape; i++)
+		vertexXM.push_back(VertexPositionColor(MousePoint[i], Colors::Red));
+	MousePoint.push_back(MousePoint[0]);
+	vertexXM.push_back(vertexXM[0]);
+	drawShape = true;
+
+	ownShapeMin = ownShapeMax = MousePoint[0];
+	for (int i = 1; i < ownButtonShape; i++)
+	{
+		ownShapeMin = Vector2::Min(ownShapeMin, MousePoint[i]);
+		ownShapeMax = Vector2::Max(ownShapeMax, MousePoint[i]);
+	}
+
+	ownShapeVertices.clear();
+	for (int i = 0; i < ownButtonShape; i++)
+		ownShapeVertices.push_back(VertexPositionColor(MousePoint[i], Colors::White));
+	ownShapeHitTest.Clear();
+	for (size_t i = 0; i + 2 < ownShapeTriangles.size(); i += 3)
+		ownShapeHitTest.AddTriangle(MousePoint[ownShapeTriangles[i]], MousePoint[ownShapeTriangles[i + 1]], MousePoint[ownShapeTriangles[i + 2]]);
+	return true;
+}
+
+void Game::ClearOwnShape()
+{
+	MousePoint.clear();
+	vertexXM.clear();
+	ownShapeTriangles.clear();
+	ownShapeVertices.clear();
+	ownShapeHitTest.Clear();
+	ownButtonShape = 0;
+	drawShape = false;
+}
+
+// Rejects on the bounding box first, only buttons that aren't boxes need the edge test
+bool isCursorInsideButton(Vector2 point, const ButtonLayout& button)
+{
+	if (point.x < button.left || point.x > button.right || point.y < button.top || point.y > button.bottom)
+		return false;
+	if (button.kind == button_box)
 		return true;
-	return false;
+
+	const ButtonCorner* c = button.corner;
+	return isCursorInsideRectangle(point, Vector2(c[0].x, c[0].y), Vector2(c[1].x, c[1].y), Vector2(c[2].x, c[2].y), Vector2(c[3].x, c[3].y));
+}
+
+bool Game::IsCursorInsideButton(ButtonTag tag)
+{
+	assert(tag < button_max);
+	return isCursorInsideButton(mPoint(), Buttons[tag]);
+}
+
+Game::ButtonTag Game::ButtonUnderCursor()
+{
+	return ButtonUnderCursor(gameState);
+}
+
+Game::ButtonTag Game::ButtonUnderCursor(GameState state)
+{
+	const Vector2 point = mPoint();
+	for (const ButtonLayout& button : Buttons)
+	{
+		if ((button.screens & ScreenBit(state)) && isCursorInsideButton(point, button))
+			return button.tag;
+	}
+	return button_null;
 }
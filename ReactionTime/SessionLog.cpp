@@ -0,0 +1,174 @@
+#include "pch.h"
+#include "SessionLog.h"
+#include <chrono>
+#include <cstdio>
+
+SessionLog::SessionLog()
+{
+	buffer.reserve(SESSION_LOG_BUFFER);
+	pending.reserve(SESSION_LOG_BUFFER);
+	writer = std::thread(&SessionLog::Run, this);
+}
+
+SessionLog::~SessionLog()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+void SessionLog::Append(const SessionRecord& record)
+{
+	// the writer only holds the lock to swap buffers, never while it writes;
+	// if it is still busy when the buffer fills up, the buffer just grows
+	bool full;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		buffer.push_back(record);
+		full = buffer.size() == SESSION_LOG_BUFFER;
+	}
+	if (full)
+		wake.notify_one();
+}
+
+void SessionLog::Flush()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		flushRequested = true;
+	}
+	wake.notify_one();
+}
+
+// Moves an outdated log out of the way, to a numbered name when the usual one can't be
+// replaced, say because a reader still has it open. Numbered ones are never replaced.
+static bool MoveOutdatedLog()
+{
+	if (MoveFileExA(SESSION_LOG_FILE, SESSION_LOG_OLD_FILE, MOVEFILE_REPLACE_EXISTING))
+		return true;
+	for (int i = 1; i <= SESSION_LOG_OLD_NAMES; i++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "sessions.old.%d.bin", i);
+		if (MoveFileExA(SESSION_LOG_FILE, name, 0))
+			return true;
+	}
+	return false;
+}
+
+// Positions a new handle at the end of the last whole record. A record torn by a crash
+// is cut off, everything appended after it would be misaligned otherwise.
+static HANDLE OpenForAppend()
+{
+	HANDLE file = CreateFileA(SESSION_LOG_FILE, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	// records can't be mixed with an older layout, move such a log out of the way
+	SessionLogHeader header = { 0, 0 };
+	DWORD read = 0;
+	if (size.QuadPart >= (LONGLONG)sizeof(header) && ReadFile(file, &header, sizeof(header), &read, nullptr) && read == sizeof(header) &&
+		(header.magic != SESSION_LOG_MAGIC || header.version != SESSION_LOG_VERSION))
+	{
+		CloseHandle(file);
+		if (!MoveOutdatedLog())
+			return INVALID_HANDLE_VALUE;
+		return OpenForAppend();
+	}
+
+	// a torn header starts the log over
+	LARGE_INTEGER end;
+	end.QuadPart = 0;
+	if (size.QuadPart >= (LONGLONG)sizeof(header))
+		end.QuadPart = sizeof(header) + (size.QuadPart - sizeof(header)) / sizeof(SessionRecord) * sizeof(SessionRecord);
+	if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || (end.QuadPart != size.QuadPart && !SetEndOfFile(file)))
+	{
+		CloseHandle(file);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	if (end.QuadPart == 0)
+	{
+		header.magic = SESSION_LOG_MAGIC;
+		header.version = SESSION_LOG_VERSION;
+		DWORD written = 0;
+		if (!WriteFile(file, &header, sizeof(header), &written, nullptr) || written != sizeof(header))
+		{
+			CloseHandle(file);
+			return INVALID_HANDLE_VALUE;
+		}
+	}
+	return file;
+}
+
+void SessionLog::Run()
+{
+	HANDLE file = INVALID_HANDLE_VALUE;
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		// records left over from a failed write are tried again after a while
+		const auto ready = [this] { return stopping || flushRequested || buffer.size() >= SESSION_LOG_BUFFER; };
+		if (pending.empty())
+			wake.wait(lock, ready);
+		else
+			wake.wait_for(lock, std::chrono::seconds(SESSION_LOG_RETRY_SECONDS), ready);
+		flushRequested = false;
+		if (pending.empty())
+			pending.swap(buffer);
+		else
+		{
+			pending.insert(pending.end(), buffer.begin(), buffer.end());
+			buffer.clear();
+		}
+		// whatever was appended before stopping is in pending now
+		const bool stop = stopping;
+		lock.unlock();
+
+		if (!pending.empty())
+		{
+			if (file == INVALID_HANDLE_VALUE)
+				file = OpenForAppend();
+			if (file == INVALID_HANDLE_VALUE)
+				failures++;
+			else
+			{
+				const DWORD bytes = static_cast<DWORD>(pending.size() * sizeof(SessionRecord));
+				DWORD written = 0;
+				// a short write leaves a torn record, reopening cuts it off before the rest is written again
+				if (!WriteFile(file, pending.data(), bytes, &written, nullptr) || written != bytes)
+				{
+					CloseHandle(file);
+					file = INVALID_HANDLE_VALUE;
+					failures++;
+				}
+				pending.erase(pending.begin(), pending.begin() + written / sizeof(SessionRecord));
+			}
+			if (pending.size() > SESSION_LOG_MAX_UNWRITTEN)
+			{
+				dropped += static_cast<unsigned int>(pending.size());
+				pending.clear();
+			}
+		}
+
+		if (stop)
+		{
+			// nothing is left to try again
+			dropped += static_cast<unsigned int>(pending.size());
+			break;
+		}
+		lock.lock();
+	}
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+}
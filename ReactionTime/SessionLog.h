@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+
+#define SESSION_LOG_FILE "sessions.bin"
+#define SESSION_LOG_MAGIC 0x474c5452 // "RTLG"
+#define SESSION_LOG_OLD_FILE "sessions.old.bin"
+#define SESSION_LOG_VERSION 2
+// records kept in memory before the writer is woken up
+#define SESSION_LOG_BUFFER 4096
+// a log that can't be written is tried again this often, holding on to at most this many records
+#define SESSION_LOG_RETRY_SECONDS 1
+#define SESSION_LOG_MAX_UNWRITTEN (16 * SESSION_LOG_BUFFER)
+// numbered names tried for an outdated log when SESSION_LOG_OLD_FILE can't be replaced
+#define SESSION_LOG_OLD_NAMES 9
+
+enum SessionFlag : uint8_t
+{
+	session_hit = 1 << 0,
+	session_crazy = 1 << 1,
+	session_gravity = 1 << 2,
+	session_epileptic = 1 << 3,
+	session_ownShape = 1 << 4,
+};
+
+#pragma pack(push, 1)
+struct SessionLogHeader
+{
+	uint32_t magic;
+	uint32_t version;
+};
+
+// One tap or miss, 28 bytes on disk
+struct SessionRecord
+{
+	int64_t timestamp;  // microseconds since 1970-01-01 UTC
+	float reactionTime; // seconds, from the Present() that showed the shape
+	float presentDelay; // seconds between generating the shape and presenting it
+	float x;
+	float y;
+	uint16_t size;
+	uint8_t shape;      // Game::ShapeTag, shape_max for an own shape
+	uint8_t flags;      // SessionFlag
+};
+#pragma pack(pop)
+
+// Append-only log of every reaction sample. Append() only copies into a
+// preallocated buffer, one writer thread lives as long as the log and swaps
+// that buffer with its own whenever it is full or Flush() asks for it, so the
+// game loop never waits on the disk or on a thread. Records that couldn't be
+// written are kept and tried again, only more than SESSION_LOG_MAX_UNWRITTEN get dropped.
+class SessionLog
+{
+public:
+	SessionLog();
+	~SessionLog();
+	void Append(const SessionRecord& record);
+	// wakes the writer, returns right away
+	void Flush();
+	// for the debug overlay, opens and writes of the log that failed and records given up on
+	unsigned int GetFailures() const { return failures; }
+	unsigned int GetDropped() const { return dropped; }
+private:
+	void Run();
+	// buffer and the flags belong to whoever holds mutex, pending only to the writer
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<SessionRecord> buffer;
+	std::vector<SessionRecord> pending;
+	std::atomic<unsigned int> failures{ 0 };
+	std::atomic<unsigned int> dropped{ 0 };
+	bool flushRequested = false;
+	bool stopping = false;
+	std::thread writer;
+};
+
+// Read-only view of the log through a memory mapped file. Builds without Windows too,
+// for the tools that query the log.
+class SessionLogReader
+{
+public:
+	~SessionLogReader() { Close(); }
+	bool Open(const char* filename = SESSION_LOG_FILE);
+	void Close();
+	size_t Count() const { return count; }
+	const SessionRecord* Records() const { return records; }
+	const SessionRecord& operator[](size_t i) const { return records[i]; }
+private:
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	size_t viewSize = 0;
+#endif
+	const void* view = nullptr;
+	const SessionRecord* records = nullptr;
+	size_t count = 0;
+};
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "SessionLog.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool SessionLogReader::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(SessionLogHeader))
+	{
+		Close();
+		return false;
+	}
+	const uint64_t size = fileSize.QuadPart;
+
+	mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		Close();
+		return false;
+	}
+
+	view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		Close();
+		return false;
+	}
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size < (off_t)sizeof(SessionLogHeader))
+	{
+		close(fd);
+		return false;
+	}
+	const uint64_t size = status.st_size;
+
+	// the mapping keeps the file open by itself
+	void* mapped = mmap(nullptr, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED)
+		return false;
+	view = mapped;
+	viewSize = (size_t)size;
+#endif
+
+	const SessionLogHeader* header = static_cast<const SessionLogHeader*>(view);
+	if (header->magic != SESSION_LOG_MAGIC || header->version != SESSION_LOG_VERSION)
+	{
+		Close();
+		return false;
+	}
+
+	// a partial record at the end (e.g. after a crash) is ignored
+	records = reinterpret_cast<const SessionRecord*>(header + 1);
+	count = static_cast<size_t>((size - sizeof(SessionLogHeader)) / sizeof(SessionRecord));
+	return true;
+}
+
+void SessionLogReader::Close()
+{
+#ifdef _WIN32
+	if (view)
+		UnmapViewOfFile(view);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+#else
+	if (view)
+		munmap(const_cast<void*>(view), viewSize);
+	viewSize = 0;
+#endif
+	view = nullptr;
+	records = nullptr;
+	count = 0;
+}
@@ -0,0 +1,136 @@
+#include "pch.h"
+#include "ShapeHitTest.h"
+
+#if SHAPE_HIT_LANES == 8
+#include <immintrin.h>
+#elif SHAPE_HIT_LANES == 4
+#include <emmintrin.h>
+#endif
+
+using namespace DirectX::SimpleMath;
+
+float calculateSign(Vector2 mPoint, Vector2 v1, Vector2 v2)
+{
+	return (mPoint.x - v2.x) * (v1.y - v2.y) - (v1.x - v2.x) * (mPoint.y - v2.y);
+}
+
+bool isCursorInsideTriangle(Vector2 mPoint, Vector2 v1, Vector2 v2, Vector2 v3)
+{
+	bool b1, b2, b3;
+
+	b1 = calculateSign(mPoint, v1, v2) < 0.0f;
+	b2 = calculateSign(mPoint, v2, v3) < 0.0f;
+	b3 = calculateSign(mPoint, v3, v1) < 0.0f;
+
+	return ((b1 == b2) && (b2 == b3));
+}
+
+bool isCursorInsideRectangle(Vector2 mPoint, Vector2 v1, Vector2 v2, Vector2 v3, Vector2 v4)
+{
+	bool b1, b2, b3, b4;
+
+	b1 = calculateSign(mPoint, v1, v2) < 0.0f;
+	b2 = calculateSign(mPoint, v2, v3) < 0.0f;
+	b3 = calculateSign(mPoint, v3, v4) < 0.0f;
+	b4 = calculateSign(mPoint, v4, v1) < 0.0f;
+
+	return ((b1 == b2) && (b2 == b3) && (b3 == b4));
+}
+
+void ShapeHitTest::Clear()
+{
+	for (int k = 0; k < 3; k++)
+	{
+		a[k].clear();
+		b[k].clear();
+		c[k].clear();
+	}
+	count = 0;
+}
+
+void ShapeHitTest::Grow()
+{
+	for (int k = 0; k < 3; k++)
+	{
+		a[k].resize(a[k].size() + SHAPE_HIT_LANES, 0.0f);
+		b[k].resize(b[k].size() + SHAPE_HIT_LANES, 0.0f);
+		c[k].resize(c[k].size() + SHAPE_HIT_LANES, -1.0f);
+	}
+}
+
+void ShapeHitTest::AddTriangle(Vector2 v1, Vector2 v2, Vector2 v3)
+{
+	const Vector2 from[3] = { v1, v2, v3 };
+	const Vector2 to[3] = { v2, v3, v1 };
+	float ea[3], eb[3], ec[3];
+	for (int k = 0; k < 3; k++)
+	{
+		// same edge function as calculateSign(), expanded to a * x + b * y + c
+		ea[k] = from[k].y - to[k].y;
+		eb[k] = to[k].x - from[k].x;
+		ec[k] = -to[k].x * ea[k] - to[k].y * eb[k];
+	}
+
+	// flip clockwise triangles so the inside is positive, nothing can be inside a flat one
+	const float area = ea[0] * v3.x + eb[0] * v3.y + ec[0];
+	if (area == 0.0f)
+		return;
+	const float sign = area > 0.0f ? 1.0f : -1.0f;
+
+	if (count == a[0].size())
+		Grow();
+	for (int k = 0; k < 3; k++)
+	{
+		a[k][count] = sign * ea[k];
+		b[k][count] = sign * eb[k];
+		c[k][count] = sign * ec[k];
+	}
+	count++;
+}
+
+bool ShapeHitTest::Contains(Vector2 point) const
+{
+	const size_t padded = a[0].size();
+#if SHAPE_HIT_LANES == 8
+	const __m256 x = _mm256_set1_ps(point.x);
+	const __m256 y = _mm256_set1_ps(point.y);
+	const __m256 zero = _mm256_setzero_ps();
+	for (size_t i = 0; i < padded; i += 8)
+	{
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int k = 0; k < 3; k++)
+		{
+			__m256 e = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&a[k][i]), x),
+				_mm256_mul_ps(_mm256_loadu_ps(&b[k][i]), y)), _mm256_loadu_ps(&c[k][i]));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(e, zero, _CMP_GE_OQ));
+		}
+		if (_mm256_movemask_ps(inside))
+			return true;
+	}
+#elif SHAPE_HIT_LANES == 4
+	const __m128 x = _mm_set1_ps(point.x);
+	const __m128 y = _mm_set1_ps(point.y);
+	const __m128 zero = _mm_setzero_ps();
+	for (size_t i = 0; i < padded; i += 4)
+	{
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int k = 0; k < 3; k++)
+		{
+			__m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&a[k][i]), x),
+				_mm_mul_ps(_mm_loadu_ps(&b[k][i]), y)), _mm_loadu_ps(&c[k][i]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(e, zero));
+		}
+		if (_mm_movemask_ps(inside))
+			return true;
+	}
+#else
+	for (size_t i = 0; i < padded; i++)
+	{
+		if (a[0][i] * point.x + b[0][i] * point.y + c[0][i] >= 0.0f &&
+			a[1][i] * point.x + b[1][i] * point.y + c[1][i] >= 0.0f &&
+			a[2][i] * point.x + b[2][i] * point.y + c[2][i] >= 0.0f)
+			return true;
+	}
+#endif
+	return false;
+}
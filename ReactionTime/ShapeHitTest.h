@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+
+// triangles tested per step, /arch:AVX builds get 8, every x64 and SSE2 build 4.
+// Defining it to 1 or 4 picks a narrower path, the tests run each of them.
+#ifndef SHAPE_HIT_LANES
+#if defined(__AVX__)
+#define SHAPE_HIT_LANES 8
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SHAPE_HIT_LANES 4
+#else
+#define SHAPE_HIT_LANES 1
+#endif
+#endif
+
+// One triangle or quad at a time, for the falling shapes and the buttons.
+// Points on an edge count as inside or not depending on the winding.
+bool isCursorInsideTriangle(DirectX::SimpleMath::Vector2 mPoint, DirectX::SimpleMath::Vector2 v1, DirectX::SimpleMath::Vector2 v2,
+	DirectX::SimpleMath::Vector2 v3);
+bool isCursorInsideRectangle(DirectX::SimpleMath::Vector2 mPoint, DirectX::SimpleMath::Vector2 v1, DirectX::SimpleMath::Vector2 v2,
+	DirectX::SimpleMath::Vector2 v3, DirectX::SimpleMath::Vector2 v4);
+
+// Triangles of a custom shape, cut once and stored as one array per edge coefficient
+// so a point gets tested against several triangles per instruction.
+// A point is inside triangle i when a[k][i] * x + b[k][i] * y + c[k][i] >= 0 for all three edges k.
+class ShapeHitTest
+{
+public:
+	void Clear();
+	void AddTriangle(DirectX::SimpleMath::Vector2 v1, DirectX::SimpleMath::Vector2 v2, DirectX::SimpleMath::Vector2 v3);
+	bool Contains(DirectX::SimpleMath::Vector2 point) const;
+	size_t TriangleCount() const { return count; }
+
+private:
+	// the arrays are padded to a whole number of SIMD registers with triangles nothing is inside
+	void Grow();
+	std::vector<float> a[3];
+	std::vector<float> b[3];
+	std::vector<float> c[3];
+	size_t count = 0;
+};
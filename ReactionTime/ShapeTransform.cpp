@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "ShapeTransform.h"
+#include "GameSize.h"
+
+using namespace DirectX::SimpleMath;
+
+const Vector2 TriangleCorners[3] = { Vector2(0.0f, -1.0f), Vector2(0.0f, 0.0f), Vector2(-1.0f, 0.0f) };
+const Vector2 RectangleCorners[4] = { Vector2(0.0f, -1.0f), Vector2(0.0f, 0.0f), Vector2(-1.0f, 0.0f), Vector2(-1.0f, -1.0f) };
+
+// corners (x + r, y - size + r), (x, y + r), (x - size + r, y - r)
+Matrix TriangleWorld(float x, float y, float r, float size)
+{
+	return Matrix(size - r, 2.0f * r, 0.0f, 0.0f,
+		-r, size, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		x, y + r, 0.0f, 1.0f);
+}
+
+// corners (x, y - size + r), (x - r, y), (x - size, y - r), (x - size + r, y - size)
+Matrix RectangleWorld(float x, float y, float r, float size)
+{
+	return Matrix(size - r, r, 0.0f, 0.0f,
+		-r, size - r, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		x - r, y, 0.0f, 1.0f);
+}
+
+Vector2 PlaceInWindow(const Vector2& boxMin, const Vector2& boxMax, float u, float v)
+{
+	const float left = -boxMin.x;
+	const float right = GAME_WIDTH - boxMax.x;
+	const float top = -boxMin.y;
+	const float bottom = GAME_HEIGHT - boxMax.y;
+	return Vector2(right >= left ? left + u * (right - left) : left, bottom >= top ? top + v * (bottom - top) : top);
+}
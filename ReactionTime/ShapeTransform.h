@@ -0,0 +1,16 @@
+#pragma once
+
+// The falling shapes in their own space, at size 1 and r = 0 with their x, y at the origin.
+// Corners in the order they are drawn and hit tested.
+extern const DirectX::SimpleMath::Vector2 TriangleCorners[3];
+extern const DirectX::SimpleMath::Vector2 RectangleCorners[4];
+
+// Places the corners above for a shape at x, y: r turns and stretches it, size scales it.
+// For BasicEffect::SetWorld() and Vector2::Transform() alike, so what is hit is what is drawn.
+DirectX::SimpleMath::Matrix TriangleWorld(float x, float y, float r, float size);
+DirectX::SimpleMath::Matrix RectangleWorld(float x, float y, float r, float size);
+
+// Where to move a custom shape with this bounding box so all of it is in the window. The offsets
+// that fit form a box, u and v in [0, 1] pick from it so every spot has the same chance.
+// A shape bigger than the window can't fit, its top left corner stays visible.
+DirectX::SimpleMath::Vector2 PlaceInWindow(const DirectX::SimpleMath::Vector2& boxMin, const DirectX::SimpleMath::Vector2& boxMax, float u, float v);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+// Wait-free ring buffer for exactly one producer and one consumer thread.
+// Capacity has to be a power of two, one slot is kept free to tell full from empty.
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	SpscQueue() : head(0), tail(0) { }
+
+	// Producer side, returns false when the queue is full
+	bool Push(const T& item)
+	{
+		const size_t current = tail.load(std::memory_order_relaxed);
+		const size_t next = (current + 1) & (Capacity - 1);
+		if (next == head.load(std::memory_order_acquire))
+			return false;
+
+		items[current] = item;
+		tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side, returns false when the queue is empty
+	bool Pop(T& item)
+	{
+		const size_t current = head.load(std::memory_order_relaxed);
+		if (current == tail.load(std::memory_order_acquire))
+			return false;
+
+		item = items[current];
+		head.store((current + 1) & (Capacity - 1), std::memory_order_release);
+		return true;
+	}
+
+	bool Empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+private:
+	// head and tail on their own cache lines so the two threads don't fight over them
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+	alignas(64) T items[Capacity];
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdint.h>
+
+// Streaming estimate of a single quantile in constant memory, using the P-square
+// algorithm (Jain & Chlamtac, 1985). Five markers track the min, max, the wanted
+// quantile and two points halfway in between.
+class P2Quantile
+{
+public:
+	explicit P2Quantile(double p) : p(p) { Reset(); }
+
+	void Reset()
+	{
+		count = 0;
+		for (int i = 0; i < 5; i++)
+		{
+			q[i] = 0.0;
+			n[i] = i;
+		}
+		np[0] = 0.0;
+		np[1] = 2.0 * p;
+		np[2] = 4.0 * p;
+		np[3] = 2.0 + 2.0 * p;
+		np[4] = 4.0;
+		dn[0] = 0.0;
+		dn[1] = p / 2.0;
+		dn[2] = p;
+		dn[3] = (1.0 + p) / 2.0;
+		dn[4] = 1.0;
+	}
+
+	void Add(double x)
+	{
+		// the first five samples are kept as they are
+		if (count < 5)
+		{
+			q[count++] = x;
+			std::sort(q, q + count);
+			return;
+		}
+		count++;
+
+		int k;
+		if (x < q[0])
+		{
+			q[0] = x;
+			k = 0;
+		}
+		else if (x >= q[4])
+		{
+			q[4] = x;
+			k = 3;
+		}
+		else
+		{
+			k = 0;
+			while (x >= q[k + 1])
+				k++;
+		}
+
+		for (int i = k + 1; i < 5; i++)
+			n[i]++;
+		for (int i = 0; i < 5; i++)
+			np[i] += dn[i];
+
+		// move the middle markers towards their desired position
+		for (int i = 1; i < 4; i++)
+		{
+			double d = np[i] - n[i];
+			if ((d >= 1.0 && n[i + 1] - n[i] > 1) || (d <= -1.0 && n[i - 1] - n[i] < -1))
+			{
+				int step = d > 0.0 ? 1 : -1;
+				double candidate = Parabolic(i, step);
+				if (q[i - 1] < candidate && candidate < q[i + 1])
+					q[i] = candidate;
+				else
+					q[i] += step * (q[i + step] - q[i]) / (n[i + step] - n[i]);
+				n[i] += step;
+			}
+		}
+	}
+
+	double Value() const
+	{
+		if (count == 0)
+			return 0.0;
+		if (count <= 5)
+		{
+			int i = std::min(count - 1, (int)std::floor(p * count));
+			return q[i];
+		}
+		return q[2];
+	}
+
+private:
+	double Parabolic(int i, int d) const
+	{
+		return q[i] + (double)d / (n[i + 1] - n[i - 1]) *
+			((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+			(n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+	}
+
+	double p;
+	int count;
+	double q[5];
+	int n[5];
+	double np[5];
+	double dn[5];
+};
+
+// Running reaction time statistics, every Add() is O(1) so readers never have to
+// rescan the samples. Mean and variance use Welford's method.
+class ReactionStats
+{
+public:
+	ReactionStats() : p50(0.5), p90(0.9), p99(0.99) { Reset(); }
+
+	void Reset()
+	{
+		count = 0;
+		min = 0.0;
+		max = 0.0;
+		mean = 0.0;
+		m2 = 0.0;
+		p50.Reset();
+		p90.Reset();
+		p99.Reset();
+	}
+
+	void Add(double x)
+	{
+		count++;
+		if (count == 1)
+		{
+			min = x;
+			max = x;
+		}
+		else
+		{
+			min = std::min(min, x);
+			max = std::max(max, x);
+		}
+		double delta = x - mean;
+		mean += delta / count;
+		m2 += delta * (x - mean);
+		p50.Add(x);
+		p90.Add(x);
+		p99.Add(x);
+	}
+
+	uint64_t Count() const { return count; }
+	double Min() const { return min; }
+	double Max() const { return max; }
+	double Mean() const { return mean; }
+	double Variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+	double StdDev() const { return std::sqrt(Variance()); }
+	double P50() const { return p50.Value(); }
+	double P90() const { return p90.Value(); }
+	double P99() const { return p99.Value(); }
+
+private:
+	uint64_t count;
+	double min;
+	double max;
+	double mean;
+	double m2;
+	P2Quantile p50;
+	P2Quantile p90;
+	P2Quantile p99;
+};
+
+// How far the time between two calls of Sample() strays from the interval the caller
+// is scheduled at, in seconds. Starts over whenever that interval changes.
+class IntervalJitter
+{
+public:
+	void Reset()
+	{
+		stats.Reset();
+		last = std::chrono::high_resolution_clock::time_point();
+	}
+
+	void Sample(double targetInterval)
+	{
+		auto now = std::chrono::high_resolution_clock::now();
+		if (targetInterval != target)
+		{
+			Reset();
+			target = targetInterval;
+		}
+		else if (last != std::chrono::high_resolution_clock::time_point())
+		{
+			std::chrono::duration<double> interval = now - last;
+			stats.Add(std::abs(interval.count() - target));
+		}
+		last = now;
+	}
+
+	const ReactionStats& Stats() const { return stats; }
+
+private:
+	ReactionStats stats;
+	std::chrono::high_resolution_clock::time_point last;
+	double target = 0.0;
+};
+
+// Process CPU time split between the game states it was spent in, as a share of one core.
+// Charge() gets the process CPU and wall clock seconds so far right before the state
+// changes and every now and then in between, everything since the last call goes to state.
+template<int States>
+class StateCpuTime
+{
+public:
+	void Charge(int state, double cpuSeconds, double wallSeconds)
+	{
+		if (started)
+		{
+			cpu[state] += cpuSeconds - lastCpu;
+			wall[state] += wallSeconds - lastWall;
+		}
+		started = true;
+		lastCpu = cpuSeconds;
+		lastWall = wallSeconds;
+	}
+
+	// percent of one core, 0 for a state nothing was charged to yet
+	double Percent(int state) const { return wall[state] > 0.0 ? 100.0 * cpu[state] / wall[state] : 0.0; }
+
+private:
+	double cpu[States] = {};
+	double wall[States] = {};
+	double lastCpu = 0.0;
+	double lastWall = 0.0;
+	bool started = false;
+};
@@ -4,38 +4,97 @@
 
 #pragma once
 
-#include <exception>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
 #include <stdint.h>
 
+#ifndef _WIN32
+#include <time.h>
+#endif
+
 namespace DX
 {
-    // Helper class for animation and simulation timing.
-    class StepTimer
+#ifdef _WIN32
+    // Clock backend on top of QueryPerformanceCounter.
+    class QpcClock
+    {
+    public:
+        uint64_t Frequency() const
+        {
+            LARGE_INTEGER frequency;
+            if (!QueryPerformanceFrequency(&frequency))
+            {
+                throw std::runtime_error("QueryPerformanceFrequency");
+            }
+            return frequency.QuadPart;
+        }
+
+        uint64_t Now() const
+        {
+            LARGE_INTEGER currentTime;
+            if (!QueryPerformanceCounter(&currentTime))
+            {
+                throw std::runtime_error("QueryPerformanceCounter");
+            }
+            return currentTime.QuadPart;
+        }
+    };
+#endif
+
+    // Portable clock backend in nanoseconds. Uses CLOCK_MONOTONIC_RAW on Linux so
+    // NTP slewing doesn't leak into the timestep, std::chrono::steady_clock elsewhere.
+    class SteadyClock
+    {
+    public:
+        uint64_t Frequency() const { return 1000000000; }
+
+        uint64_t Now() const
+        {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_RAW)
+            timespec currentTime;
+            if (clock_gettime(CLOCK_MONOTONIC_RAW, &currentTime) != 0)
+            {
+                throw std::runtime_error("clock_gettime");
+            }
+            return static_cast<uint64_t>(currentTime.tv_sec) * 1000000000 + currentTime.tv_nsec;
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+    };
+
+#ifdef _WIN32
+    typedef QpcClock DefaultClock;
+#else
+    typedef SteadyClock DefaultClock;
+#endif
+
+    // Helper class for animation and simulation timing. TClock provides Now() and
+    // Frequency() in its own units, everything else runs on canonical ticks.
+    template<typename TClock>
+    class BasicStepTimer
     {
     public:
-        StepTimer() : 
+        explicit BasicStepTimer(const TClock& clock = TClock()) : 
+            m_clock(clock),
             m_elapsedTicks(0),
             m_totalTicks(0),
             m_leftOverTicks(0),
             m_frameCount(0),
             m_framesPerSecond(0),
             m_framesThisSecond(0),
-            m_qpcSecondCounter(0),
+            m_clockSecondCounter(0),
+            m_clockRemainder(0),
             m_isFixedTimeStep(false),
             m_targetElapsedTicks(TicksPerSecond / 60)
         {
-            if (!QueryPerformanceFrequency(&m_qpcFrequency))
-            {
-                throw std::exception( "QueryPerformanceFrequency" );
-            }
-
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception( "QueryPerformanceCounter" );
-            }
+            m_clockFrequency = m_clock.Frequency();
+            m_clockLastTime = m_clock.Now();
 
             // Initialize max delta to 1/10 of a second.
-            m_qpcMaxDelta = m_qpcFrequency.QuadPart / 10;
+            m_clockMaxDelta = m_clockFrequency / 10;
         }
 
         // Get elapsed time since the previous Update call.
@@ -71,15 +130,37 @@ namespace DX
 
         void ResetElapsedTime()
         {
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception("QueryPerformanceCounter");
-            }
+            m_clockLastTime = m_clock.Now();
 
             m_leftOverTicks = 0;
             m_framesPerSecond = 0;
             m_framesThisSecond = 0;
-            m_qpcSecondCounter = 0;
+            m_clockSecondCounter = 0;
+            m_clockRemainder = 0;
+        }
+
+        // Time left until Tick will run the next fixed timestep Update, so the caller can
+        // sleep in between instead of spinning.
+        double GetSecondsUntilNextUpdate() const
+        {
+            if (!m_isFixedTimeStep)
+            {
+                return 0.0;
+            }
+
+            uint64_t timeDelta = m_clock.Now() - m_clockLastTime;
+            if (timeDelta > m_clockMaxDelta)
+            {
+                timeDelta = m_clockMaxDelta;
+            }
+            timeDelta = (timeDelta * TicksPerSecond + m_clockRemainder) / m_clockFrequency;
+
+            uint64_t pendingTicks = m_leftOverTicks + timeDelta;
+            if (pendingTicks >= m_targetElapsedTicks)
+            {
+                return 0.0;
+            }
+            return TicksToSeconds(m_targetElapsedTicks - pendingTicks);
         }
 
         // Update timer state, calling the specified Update function the appropriate number of times.
@@ -87,27 +168,24 @@ namespace DX
         void Tick(const TUpdate& update)
         {
             // Query the current time.
-            LARGE_INTEGER currentTime;
-
-            if (!QueryPerformanceCounter(&currentTime))
-            {
-                throw std::exception( "QueryPerformanceCounter" );
-            }
+            uint64_t currentTime = m_clock.Now();
 
-            uint64_t timeDelta = currentTime.QuadPart - m_qpcLastTime.QuadPart;
+            uint64_t timeDelta = currentTime - m_clockLastTime;
 
-            m_qpcLastTime = currentTime;
-            m_qpcSecondCounter += timeDelta;
+            m_clockLastTime = currentTime;
+            m_clockSecondCounter += timeDelta;
 
             // Clamp excessively large time deltas (e.g. after paused in the debugger).
-            if (timeDelta > m_qpcMaxDelta)
+            if (timeDelta > m_clockMaxDelta)
             {
-                timeDelta = m_qpcMaxDelta;
+                timeDelta = m_clockMaxDelta;
             }
 
-            // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
-            timeDelta *= TicksPerSecond;
-            timeDelta /= m_qpcFrequency.QuadPart;
+            // Convert clock units into a canonical tick format. This cannot overflow due to the previous clamp.
+            // What doesn't make a whole tick carries over, clock units that don't divide evenly would drift otherwise.
+            timeDelta = timeDelta * TicksPerSecond + m_clockRemainder;
+            m_clockRemainder = timeDelta % m_clockFrequency;
+            timeDelta /= m_clockFrequency;
 
             uint32_t lastFrameCount = m_frameCount;
 
@@ -121,8 +199,11 @@ namespace DX
                 // fixed update, running with vsync enabled on a 59.94 NTSC display, would eventually
                 // accumulate enough tiny errors that it would drop a frame. It is better to just round 
                 // small deviations down to zero to leave things running smoothly.
+                // Short steps get a proportionally smaller window, at 1 kHz a quarter millisecond would be a
+                // quarter of every step and late wakeups would be rounded away until the game runs slow.
 
-                if (abs(static_cast<int64_t>(timeDelta - m_targetElapsedTicks)) < TicksPerSecond / 4000)
+                const uint64_t snapTicks = m_targetElapsedTicks / 64 < TicksPerSecond / 4000 ? m_targetElapsedTicks / 64 : TicksPerSecond / 4000;
+                if (static_cast<uint64_t>(std::llabs(static_cast<int64_t>(timeDelta - m_targetElapsedTicks))) < snapTicks)
                 {
                     timeDelta = m_targetElapsedTicks;
                 }
@@ -156,19 +237,20 @@ namespace DX
                 m_framesThisSecond++;
             }
 
-            if (m_qpcSecondCounter >= static_cast<uint64_t>(m_qpcFrequency.QuadPart))
+            if (m_clockSecondCounter >= m_clockFrequency)
             {
                 m_framesPerSecond = m_framesThisSecond;
                 m_framesThisSecond = 0;
-                m_qpcSecondCounter %= m_qpcFrequency.QuadPart;
+                m_clockSecondCounter %= m_clockFrequency;
             }
         }
 
     private:
-        // Source timing data uses QPC units.
-        LARGE_INTEGER m_qpcFrequency;
-        LARGE_INTEGER m_qpcLastTime;
-        uint64_t m_qpcMaxDelta;
+        // Source timing data uses clock units.
+        TClock m_clock;
+        uint64_t m_clockFrequency;
+        uint64_t m_clockLastTime;
+        uint64_t m_clockMaxDelta;
 
         // Derived timing data uses a canonical tick format.
         uint64_t m_elapsedTicks;
@@ -179,10 +261,14 @@ namespace DX
         uint32_t m_frameCount;
         uint32_t m_framesPerSecond;
         uint32_t m_framesThisSecond;
-        uint64_t m_qpcSecondCounter;
+        uint64_t m_clockSecondCounter;
+        // clock units times TicksPerSecond not converted into ticks yet
+        uint64_t m_clockRemainder;
 
         // Members for configuring fixed timestep mode.
         bool m_isFixedTimeStep;
         uint64_t m_targetElapsedTicks;
     };
+
+    typedef BasicStepTimer<DefaultClock> StepTimer;
 }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include "SpscQueue.h"
+
+// Times reactions from the moment a shape made it to the screen. The simulation thread
+// generates shapes, the render thread reports the first present of each one back through
+// a wait-free queue, and only the simulation thread reads what came back.
+class StimulusClock
+{
+public:
+	typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+	// Simulation side, a new shape was generated at now, returns its stimulus id for the frame
+	unsigned int Generate(TimePoint now)
+	{
+		pending = true;
+		generated = now;
+		return ++stimulus;
+	}
+	// starts the timer once the current shape was presented, reports of older ones are stale
+	void Process()
+	{
+		Shown shown;
+		while (presented.Pop(shown))
+		{
+			if (!pending || shown.stimulus != stimulus)
+				continue;
+
+			start = shown.time;
+			std::chrono::duration<double> delay = start - generated;
+			presentDelay = delay.count();
+			pending = false;
+		}
+	}
+	// the current shape isn't on screen yet
+	bool Pending() const { return pending; }
+	unsigned int Stimulus() const { return stimulus; }
+	TimePoint StartTime() const { return start; }
+	// seconds between generating the last presented shape and presenting it
+	double PresentDelay() const { return presentDelay; }
+	// seconds the shape was on screen at eventTime, 0 before it was presented
+	double Elapsed(TimePoint eventTime) const
+	{
+		if (pending)
+			return 0.0;
+		std::chrono::duration<double> elapsed = eventTime - start;
+		return elapsed.count() < 0.0 ? 0.0 : elapsed.count();
+	}
+
+	// Render side, a frame showing stimulus was presented at time. Only its first present
+	// is reported, a full queue is tried again with the next one.
+	void Presented(unsigned int shownStimulus, TimePoint time)
+	{
+		if (shownStimulus == presentedStimulus)
+			return;
+		Shown shown = { shownStimulus, time };
+		if (presented.Push(shown))
+			presentedStimulus = shownStimulus;
+	}
+
+private:
+	struct Shown { unsigned int stimulus; TimePoint time; };
+	SpscQueue<Shown, 16> presented;
+	unsigned int presentedStimulus = 0;
+	unsigned int stimulus = 0;
+	bool pending = false;
+	TimePoint generated;
+	TimePoint start;
+	double presentDelay = 0.0;
+};
@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "Triangulate.h"
+#include <cmath>
+#include <utility>
+
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+	// twice the signed area of a, b, c, positive when they turn the same way as a positive polygon
+	float cross(Vector2 a, Vector2 b, Vector2 c)
+	{
+		return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	}
+
+	// whether outline point p, between before and after, keeps the ear a, b, c from being cut.
+	// Inside it always does. On an edge only when the outline at p turns into the ear,
+	// an outline that just touches the ear from outside leaves it a valid cut.
+	bool blocksEar(Vector2 p, Vector2 before, Vector2 after, Vector2 a, Vector2 b, Vector2 c)
+	{
+		const Vector2 from[3] = { a, b, c };
+		const Vector2 to[3] = { b, c, a };
+		float side[3];
+		for (int k = 0; k < 3; k++)
+		{
+			side[k] = cross(from[k], to[k], p);
+			if (side[k] < 0.0f)
+				return false;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			if (side[k] == 0.0f && (cross(from[k], to[k], before) > 0.0f || cross(from[k], to[k], after) > 0.0f))
+				return true;
+		}
+		return side[0] > 0.0f && side[1] > 0.0f && side[2] > 0.0f;
+	}
+
+	float distanceSquared(Vector2 a, Vector2 b)
+	{
+		return (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+	}
+
+	float segmentDistanceSquared(Vector2 p, Vector2 a, Vector2 b)
+	{
+		const float length = distanceSquared(a, b);
+		if (length == 0.0f)
+			return distanceSquared(p, a);
+		float t = ((p.x - a.x) * (b.x - a.x) + (p.y - a.y) * (b.y - a.y)) / length;
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		return distanceSquared(p, Vector2(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)));
+	}
+}
+
+float TriangulatePolygon(const Vector2* points, int count, std::vector<uint16_t>& triangles)
+{
+	triangles.clear();
+	if (count < 3)
+		return 0.0f;
+
+	// remaining outline as a ring, walked so the inside is always on the positive side
+	float area = 0.0f;
+	for (int i = 0; i < count; i++)
+		area += cross(Vector2(0.0f, 0.0f), points[i], points[(i + 1) % count]);
+	const float turn = area < 0.0f ? -1.0f : 1.0f;
+
+	std::vector<int> prev(count), next(count);
+	for (int i = 0; i < count; i++)
+	{
+		prev[i] = (i + count - 1) % count;
+		next[i] = (i + 1) % count;
+	}
+	triangles.reserve(3 * (count - 2));
+
+	float covered = 0.0f;
+	auto cut = [&](int p, int v, int n)
+	{
+		triangles.push_back(static_cast<uint16_t>(p));
+		triangles.push_back(static_cast<uint16_t>(v));
+		triangles.push_back(static_cast<uint16_t>(n));
+		covered += std::fabs(cross(points[p], points[v], points[n])) / 2.0f;
+	};
+
+	int left = count;
+	int v = 0;
+	// vertices looked at since the last clip, once it reaches left there is no ear anymore
+	int tried = 0;
+	// a convex corner looked at since the last clip, the best cut when there is no ear
+	int convex = -1;
+	while (left > 3)
+	{
+		int p = prev[v];
+		int n = next[v];
+		const float corner = turn * cross(points[p], points[v], points[n]);
+
+		bool ear = corner > 0.0f;
+		if (ear)
+		{
+			// only reflex vertices can lie inside a convex corner
+			for (int r = next[n]; r != p && ear; r = next[r])
+			{
+				if (turn * cross(points[prev[r]], points[r], points[next[r]]) > 0.0f)
+					continue;
+				if (points[r] == points[p] || points[r] == points[v] || points[r] == points[n])
+					continue;
+				if (turn > 0.0f ? blocksEar(points[r], points[prev[r]], points[next[r]], points[p], points[v], points[n])
+					: blocksEar(points[r], points[prev[r]], points[next[r]], points[n], points[v], points[p]))
+					ear = false;
+			}
+			if (!ear)
+				convex = v;
+		}
+
+		// a crossing outline can leave no ears, its convex corners still overlap the least
+		if (!ear && corner != 0.0f && tried >= left)
+		{
+			if (convex >= 0)
+			{
+				v = convex;
+				p = prev[v];
+				n = next[v];
+			}
+			ear = true;
+		}
+
+		// a straight or doubled point is cut off as a flat triangle, every point ends up in one
+		if (ear || corner == 0.0f)
+		{
+			cut(p, v, n);
+			next[p] = n;
+			prev[n] = p;
+			left--;
+			tried = 0;
+			convex = -1;
+			v = p;
+			continue;
+		}
+
+		tried++;
+		v = n;
+	}
+
+	cut(prev[v], v, next[v]);
+	return covered;
+}
+
+void SimplifyPolygon(std::vector<Vector2>& points, float tolerance)
+{
+	const size_t count = points.size();
+	if (tolerance <= 0.0f || count <= 3)
+		return;
+
+	// cut the ring at the point farthest from the first one, leaving two open halves
+	size_t split = 0;
+	float farthest = 0.0f;
+	for (size_t i = 1; i < count; i++)
+	{
+		const float d = distanceSquared(points[0], points[i]);
+		if (d > farthest)
+		{
+			farthest = d;
+			split = i;
+		}
+	}
+	if (split == 0)
+		return;
+
+	std::vector<bool> keep(count, false);
+	keep[0] = true;
+	keep[split] = true;
+
+	// spans still to check, the end index count stands for the first point again
+	std::vector<std::pair<size_t, size_t>> spans;
+	spans.push_back(std::make_pair(0, split));
+	spans.push_back(std::make_pair(split, count));
+	const float limit = tolerance * tolerance;
+	while (!spans.empty())
+	{
+		const size_t first = spans.back().first;
+		const size_t last = spans.back().second;
+		spans.pop_back();
+
+		float worst = limit;
+		size_t at = first;
+		for (size_t i = first + 1; i < last; i++)
+		{
+			const float d = segmentDistanceSquared(points[i], points[first], points[last % count]);
+			if (d > worst)
+			{
+				worst = d;
+				at = i;
+			}
+		}
+		if (at == first)
+			continue;
+
+		keep[at] = true;
+		spans.push_back(std::make_pair(first, at));
+		spans.push_back(std::make_pair(at, last));
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (keep[i])
+			points[kept++] = points[i];
+	}
+	points.resize(kept);
+}
+
+bool SimplifyAndTriangulate(std::vector<Vector2>& points, float tolerance, size_t maxPoints, std::vector<uint16_t>& triangles)
+{
+	const std::vector<Vector2> outline(points);
+	SimplifyPolygon(points, tolerance);
+	// long freehand outlines give up detail until the cut is cheap enough
+	while (points.size() > maxPoints)
+	{
+		tolerance = tolerance > 0.0f ? tolerance * 2.0f : 1.0f;
+		SimplifyPolygon(points, tolerance);
+	}
+	float area = TriangulatePolygon(points.data(), static_cast<int>(points.size()), triangles);
+	// simplifying can flatten a thin shape down to a line, the drawn outline may still have area
+	if (area == 0.0f && outline.size() <= maxPoints)
+	{
+		points = outline;
+		area = TriangulatePolygon(points.data(), static_cast<int>(points.size()), triangles);
+	}
+	if (area == 0.0f)
+	{
+		points = outline;
+		triangles.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+// Cuts a simple polygon, given as its outline without the closing point, into triangles by
+// clipping ears. Writes three indices into points per triangle, ready for DrawIndexed(),
+// always count - 2 of them: straight and doubled points end up in flat ones.
+// Concave outlines come out right, self intersecting ones still get covered but not exactly,
+// though the signed areas of the triangles still add up to the outline's.
+// Returns the area of the triangles, 0 when the outline has none.
+float TriangulatePolygon(const DirectX::SimpleMath::Vector2* points, int count, std::vector<uint16_t>& triangles);
+
+// Drops outline points (Douglas-Peucker) as long as the outline stays within tolerance
+// pixels of the original one. The outline is closed, the first point is always kept.
+void SimplifyPolygon(std::vector<DirectX::SimpleMath::Vector2>& points, float tolerance);
+
+// What the editor does with a closed freehand outline: simplifies it within tolerance, doubling the
+// tolerance until at most maxPoints are left, and cuts it into triangles. When simplifying flattened
+// it, the outline as drawn is cut instead, if it fits maxPoints. Returns false and leaves points
+// as they were when there is no area to cut.
+bool SimplifyAndTriangulate(std::vector<DirectX::SimpleMath::Vector2>& points, float tolerance, size_t maxPoints,
+	std::vector<uint16_t>& triangles);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+
+// Hands the newest value from exactly one writer thread to exactly one reader thread.
+// Neither side ever waits: the writer swaps its filled slot with the spare one, the
+// reader swaps its slot with the spare one whenever that holds something newer.
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : back(0), spare(1), front(2) { }
+
+	// Writer side, Back() has to be filled completely before every Publish()
+	T& Back() { return slots[back]; }
+	void Publish()
+	{
+		back = spare.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// Reader side, returns false when nothing was published since the last call
+	bool Acquire()
+	{
+		if (!(spare.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		front = spare.exchange(front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	const T& Front() const { return slots[front]; }
+
+private:
+	// the spare index carries a flag telling the reader it hasn't seen that slot yet
+	enum { INDEX = 0x3, FRESH = 0x4 };
+
+	T slots[3];
+	unsigned char back;
+	// on its own cache line so the writer filling Back() doesn't slow down the reader
+	alignas(64) std::atomic<unsigned char> spare;
+	alignas(64) unsigned char front;
+};
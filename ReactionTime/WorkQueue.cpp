@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "WorkQueue.h"
+
+WorkQueue::WorkQueue()
+{
+	worker = std::thread(&WorkQueue::Run, this);
+}
+
+void WorkQueue::Push(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	wake.notify_one();
+}
+
+void WorkQueue::Stop()
+{
+	if (!worker.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void WorkQueue::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+		if (jobs.empty())
+			break;
+
+		std::function<void()> job = std::move(jobs.front());
+		jobs.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+	}
+}
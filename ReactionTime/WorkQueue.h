@@ -0,0 +1,27 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// Runs jobs one after another, in the order they were pushed, on a thread of its own.
+// For disk work that must neither block the simulation nor happen while the game
+// state is locked. Jobs get copies of what they write, not the game's members.
+class WorkQueue
+{
+public:
+	WorkQueue();
+	~WorkQueue() { Stop(); }
+	void Push(std::function<void()> job);
+	// runs everything still queued, then ends the thread
+	void Stop();
+private:
+	void Run();
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<std::function<void()>> jobs;
+	bool stopping = false;
+	std::thread worker;
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+// Only the game needs Windows and DirectX, the session log reader, History, StepTimer and
+// the drawing and shape code also build elsewhere for the tools and tests
+#ifdef _WIN32
 #include <WinSDKVer.h>
 #define _WIN32_WINNT 0x0601  
 #include <SDKDDKVer.h>
@@ -8,6 +11,11 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
+// Windows 10 1803+, older versions fail CreateWaitableTimerEx with this flag
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 #include <wrl/client.h>
 
 #include <d3d11_1.h>
@@ -41,4 +49,9 @@ namespace DX
 			throw std::exception();
 		}
     }
-}
\ No newline at end of file
+}
+#else
+#include <exception>
+#include <memory>
+#include "DrawTypes.h"
+#endif
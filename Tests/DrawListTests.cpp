@@ -0,0 +1,189 @@
+#include "Test.h"
+#include "pch.h"
+#include "ButtonMeshes.h"
+#include "DrawList.h"
+#include "HudText.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const XMVECTORF32 red = { { 1.0f, 0.0f, 0.0f, 1.0f } };
+	const XMVECTORF32 green = { { 0.678f, 1.0f, 0.184f, 1.0f } };
+	const XMVECTORF32 black = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+	// stands in for SpriteFont::MeasureString() / 2
+	void Measure(HudText& hud)
+	{
+		hud.origin = XMFLOAT2(8.0f * wcslen(hud.Text()) / 2.0f, 16.0f);
+	}
+
+	// what Render() records for the options menu in release builds
+	void RecordOptionsMenu(DrawList& drawList, const ButtonMeshes& buttons, GameTags::ButtonTag hovered, unsigned int switchedOn)
+	{
+		buttons.Record(drawList, GameTags::state_optionsmenu, hovered, switchedOn, black);
+		const XMFLOAT2 origin(40.0f, 8.0f);
+		drawList.AddText(L"Game Time: 30", 500.0f, 80.0f, red, 0.0f, 0.5f, origin);
+		drawList.AddText(L"Shape Size: 60", 500.0f, 100.0f, red, 0.0f, 0.5f, origin);
+		drawList.AddText(L"Credits: 0", 500.0f, 120.0f, red, 0.0f, 0.5f, origin);
+		drawList.AddText(L"Lifetime median: 0.000", 500.0f, 140.0f, red, 0.0f, 0.5f, origin);
+	}
+}
+
+TEST(OptionsMenuIsOnePrimitivePassAndOneTextPass)
+{
+	std::vector<VertexPositionColor> vertices;
+	ButtonMeshes buttons;
+	buttons.Append(vertices, red, green);
+	CountingDrawBackend backend;
+	backend.SetStaticVertices(vertices.data(), vertices.size());
+	DrawList drawList;
+
+	// nothing hovered, every option off: the screen's buttons are one static draw
+	RecordOptionsMenu(drawList, buttons, GameTags::button_null, 0);
+	drawList.Submit(backend);
+	CHECK(backend.passes == 2);
+	CHECK(backend.stateChanges == 3);
+	CHECK(backend.drawCalls == 2);
+	// start, crazy, sound, four arrows, three toggles and back
+	CHECK(backend.primitives == 11 * 2);
+	// eight labels and four values
+	CHECK(backend.strings == 12);
+
+	// every highlight is another draw from the same buffer, without touching any state
+	backend.Reset();
+	const unsigned int switchedOn = 1u << GameTags::button_useOwnShape | 1u << GameTags::button_useGravity | 1u << GameTags::button_epileptic;
+	RecordOptionsMenu(drawList, buttons, GameTags::button_start, switchedOn);
+	drawList.Submit(backend);
+	CHECK(backend.passes == 2);
+	CHECK(backend.stateChanges == 3);
+	CHECK(backend.drawCalls == 6);
+	CHECK(backend.primitives == 15 * 2);
+	CHECK(backend.strings == 12);
+}
+
+TEST(HighlightsOnlyFollowTheirOwnButtons)
+{
+	std::vector<VertexPositionColor> vertices;
+	ButtonMeshes buttons;
+	buttons.Append(vertices, red, green);
+	CountingDrawBackend backend;
+	DrawList drawList;
+
+	// hovering a toggle doesn't light it up, switching on a button that isn't a toggle doesn't either,
+	// and nothing of another screen shows up
+	buttons.Record(drawList, GameTags::state_optionsmenu, GameTags::button_useGravity, 1u << GameTags::button_start, black);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 2);
+	CHECK(backend.primitives == 11 * 2);
+
+	backend.Reset();
+	buttons.Record(drawList, GameTags::state_optionsmenu, GameTags::button_editor, 0, black);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 2);
+	CHECK(backend.primitives == 11 * 2);
+
+	// start is only labelled outside the options menu
+	backend.Reset();
+	buttons.Record(drawList, GameTags::state_startmenu, GameTags::button_start, 0, black);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 3);
+	CHECK(backend.strings == 4);
+}
+
+TEST(PlayFrameRecordsWithoutAllocating)
+{
+	const StaticMesh hudMesh = { D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 0, 18 };
+	const StaticMesh triangleMesh = { D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 18, 3 };
+	const uint16_t ownShapeIndices[6] = { 0, 1, 2, 0, 2, 3 };
+	const VertexPositionColor ownShape[4] = {
+		VertexPositionColor(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
+		VertexPositionColor(XMFLOAT3(50.0f, 0.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
+		VertexPositionColor(XMFLOAT3(50.0f, 50.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
+		VertexPositionColor(XMFLOAT3(0.0f, 50.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)) };
+	enum { hud_time, hud_reactionTime, hud_shapes, hud_max };
+	HudText hud[hud_max];
+	CountingDrawBackend backend;
+	DrawList drawList;
+
+	// what Render() records in state_play, ShowTime() measures a slot again only when its text changed
+	auto recordFrame = [&](int frame)
+	{
+		const double gameTime = 30.0 - frame * 0.001;
+		drawList.AddStatic(hudMesh);
+		if (hud[hud_time].Set(L"Time:", gameTime, 2))
+			Measure(hud[hud_time]);
+		drawList.AddText(hud[hud_time].Text(), 110.0f, 570.0f, black, 0.0f, 0.8f, hud[hud_time].origin);
+		drawList.AddText(L"-1", 105.0f, 520.0f + frame % 50, red, 0.0f, 0.6f, XMFLOAT2(8.0f, 8.0f));
+		drawList.AddText(L"Great!", 500.0f, 65.0f, red, 0.0f, 0.75f, XMFLOAT2(24.0f, 8.0f));
+		if (hud[hud_reactionTime].Set(L"", 0.25 + frame * 1e-4, 3))
+			Measure(hud[hud_reactionTime]);
+		drawList.AddText(hud[hud_reactionTime].Text(), 500.0f, 26.0f, black, 0.0f, 1.0f, hud[hud_reactionTime].origin);
+		if (hud[hud_shapes].Set(L"Shapes:", frame / 100, 0))
+			Measure(hud[hud_shapes]);
+		drawList.AddText(hud[hud_shapes].Text(), 885.0f, 570.0f, black, 0.0f, 0.8f, hud[hud_shapes].origin);
+		// the falling shape, then the custom one, each through its own world
+		drawList.AddStatic(triangleMesh, SimpleMath::Matrix::CreateTranslation(frame * 0.1f, 300.0f, 0.0f), red);
+		drawList.AddIndexed(ownShapeIndices, 6, ownShape, 4, SimpleMath::Matrix::CreateTranslation(200.0f, frame * 0.1f, 0.0f), green);
+		drawList.Submit(backend);
+	};
+
+	// the first frame sizes the list's buffers, every later one reuses them
+	recordFrame(0);
+	backend.Reset();
+	allocations = 0;
+	watchAllocations = true;
+	for (int frame = 1; frame <= 10000; frame++)
+		recordFrame(frame);
+	watchAllocations = false;
+	CHECK(allocations == 0);
+	CHECK(backend.strings == 5 * 10000);
+	CHECK(backend.passes == 3 * 10000);
+}
+
+TEST(DrawsSharingATransformSetItOnce)
+{
+	const StaticMesh mesh = { D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 0, 3 };
+	const uint16_t indices[3] = { 0, 1, 2 };
+	const VertexPositionColor triangle[3] = {
+		VertexPositionColor(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
+		VertexPositionColor(XMFLOAT3(50.0f, 0.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
+		VertexPositionColor(XMFLOAT3(0.0f, 50.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)) };
+	const SimpleMath::Matrix here = SimpleMath::Matrix::CreateTranslation(100.0f, 200.0f, 0.0f);
+	const SimpleMath::Matrix there = SimpleMath::Matrix::CreateTranslation(300.0f, 200.0f, 0.0f);
+	CountingDrawBackend backend;
+	DrawList drawList;
+
+	// the pass, the transform, the draw and going back to identity
+	drawList.AddIndexed(indices, 3, triangle, 3, here, red);
+	drawList.AddIndexed(indices, 3, triangle, 3, here, red);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 1);
+	CHECK(backend.primitives == 2);
+	CHECK(backend.stateChanges == 4);
+
+	backend.Reset();
+	drawList.AddStatic(mesh, here, red);
+	drawList.AddStatic(mesh, here, red);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 2);
+	CHECK(backend.stateChanges == 4);
+
+	// another world or another tint is another transform
+	backend.Reset();
+	drawList.AddIndexed(indices, 3, triangle, 3, here, red);
+	drawList.AddIndexed(indices, 3, triangle, 3, there, red);
+	drawList.AddIndexed(indices, 3, triangle, 3, there, green);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 3);
+	CHECK(backend.stateChanges == 8);
+
+	// only neighbours merge, what is drawn in between stays in between
+	backend.Reset();
+	drawList.AddStatic(mesh, here, red);
+	drawList.AddStatic(mesh);
+	drawList.AddStatic(mesh, here, red);
+	drawList.Submit(backend);
+	CHECK(backend.drawCalls == 3);
+	CHECK(backend.stateChanges == 8);
+}
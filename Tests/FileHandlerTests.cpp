@@ -0,0 +1,206 @@
+#include "Test.h"
+#include "pch.h"
+#include "FileHandler.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	// config.txt is relative, the tests work in a directory of their own
+	struct ScratchDirectory
+	{
+		ScratchDirectory()
+		{
+			if (!getcwd(previous, sizeof(previous)))
+				previous[0] = '\0';
+			snprintf(path, sizeof(path), "/tmp/configtestXXXXXX");
+			ready = mkdtemp(path) && chdir(path) == 0;
+		}
+		~ScratchDirectory()
+		{
+			remove(CONFIG_FILE);
+			remove(CONFIG_TEMP_FILE);
+			if (previous[0] && chdir(previous) == 0)
+				rmdir(path);
+		}
+		char previous[4096];
+		char path[64];
+		bool ready;
+	};
+
+	// everything a save with this number writes, so a file mixing two saves shows
+	void SetAll(FileHandler& handler, int i)
+	{
+		handler.SetConfig(i, i % SHAPE_SIZE_MAX + 1, i % GAME_TIME_MAX + 1);
+		handler.SetOptions((i & 1) != 0, (i & 2) != 0, (i & 4) != 0);
+	}
+
+	bool MatchesOneSave(const FileHandler& handler)
+	{
+		const Config& config = handler.GetConfig();
+		const int i = config.credits;
+		return !handler.IsDirty() && i > 0 && config.shapeSize == i % SHAPE_SIZE_MAX + 1 && config.gameTime == i % GAME_TIME_MAX + 1 &&
+			config.useGravity == ((i & 1) != 0) && config.epilepticMode == ((i & 2) != 0) && config.useOwnShape == ((i & 4) != 0);
+	}
+}
+
+TEST(ConfigSurvivesBeingKilledMidWrite)
+{
+	ScratchDirectory scratch;
+	CHECK(scratch.ready);
+	if (!scratch.ready)
+		return;
+
+	int found = 0;
+	int torn = 0;
+	unsigned int seed = 12345;
+	for (int round = 0; round < 100; round++)
+	{
+		fflush(stdout);
+		const pid_t child = fork();
+		if (child == 0)
+		{
+			// saves as fast as it can until it is killed
+			FileHandler handler;
+			for (int i = 1; ; i++)
+			{
+				SetAll(handler, i);
+				handler.SaveConfig();
+			}
+		}
+		CHECK(child > 0);
+		if (child < 0)
+			return;
+		seed = seed * 1103515245u + 12345u;
+		usleep(500 + (seed >> 8) % 5000);
+		kill(child, SIGKILL);
+		waitpid(child, nullptr, 0);
+
+		FileHandler handler;
+		if (!handler.FileExists(CONFIG_FILE))
+			continue;
+		found++;
+		handler.LoadConfig();
+		torn += !MatchesOneSave(handler);
+	}
+	CHECK(found > 0);
+	CHECK(torn == 0);
+}
+
+namespace
+{
+	void WriteFile(const char* text)
+	{
+		FILE* file = fopen(CONFIG_FILE, "wb");
+		if (!file)
+			return;
+		fputs(text, file);
+		fclose(file);
+	}
+}
+
+TEST(LegacyConfigIsMigrated)
+{
+	ScratchDirectory scratch;
+	CHECK(scratch.ready);
+
+	// credits, shape size and game time on three lines, the way version 1 wrote them
+	WriteFile("1234\n150\n20");
+	FileHandler handler;
+	handler.LoadConfig();
+	CHECK(handler.GetCredits() == 1234);
+	CHECK(handler.GetShapeSize() == 150);
+	CHECK(handler.GetGameTime() == 20);
+	CHECK(!handler.GetConfig().useGravity && !handler.GetConfig().epilepticMode && !handler.GetConfig().useOwnShape);
+	CHECK(handler.IsDirty());
+
+	// rewritten right away, and the new file reads back the same without another rewrite
+	handler.SaveConfig();
+	CHECK(!handler.IsDirty());
+	FileHandler reloaded;
+	reloaded.LoadConfig();
+	CHECK(!reloaded.IsDirty());
+	CHECK(reloaded.GetCredits() == 1234);
+	CHECK(reloaded.GetShapeSize() == 150);
+	CHECK(reloaded.GetGameTime() == 20);
+
+	// out of range values and Windows line ends
+	WriteFile("-5\r\n99999\r\n0\r\n");
+	handler.LoadConfig();
+	CHECK(handler.GetCredits() == 0);
+	CHECK(handler.GetShapeSize() == SHAPE_SIZE_MAX);
+	CHECK(handler.GetGameTime() == DEFAULT_GAME_TIME);
+	CHECK(handler.IsDirty());
+
+	// no config at all gets the defaults written
+	remove(CONFIG_FILE);
+	handler.LoadConfig();
+	CHECK(handler.GetShapeSize() == DEFAULT_SHAPE_SIZE);
+	CHECK(handler.GetGameTime() == DEFAULT_GAME_TIME);
+	CHECK(handler.IsDirty());
+}
+
+TEST(UnknownKeysAndBadVersionsAreHandled)
+{
+	ScratchDirectory scratch;
+	CHECK(scratch.ready);
+	FileHandler handler;
+
+	// a newer build's keys, comments and stray lines are skipped, the rest still counts
+	WriteFile("# settings\nversion=2\nvolume=80\ncredits=12\nstray line\nshapeSize=90\ngameTime=7\nuseGravity=1\ncolorScheme=dark\n");
+	handler.LoadConfig();
+	CHECK(handler.GetCredits() == 12);
+	CHECK(handler.GetShapeSize() == 90);
+	CHECK(handler.GetGameTime() == 7);
+	CHECK(handler.GetConfig().useGravity);
+	CHECK(!handler.IsDirty());
+
+	// another version keeps its values and gets rewritten
+	WriteFile("version=3\ncredits=40\nshapeSize=100\n");
+	handler.LoadConfig();
+	CHECK(handler.GetCredits() == 40);
+	CHECK(handler.GetShapeSize() == 100);
+	CHECK(handler.IsDirty());
+
+	// so do a broken or missing version, they aren't taken for the positional format
+	WriteFile("version=two\ncredits=41\ngameTime=9\n");
+	handler.LoadConfig();
+	CHECK(handler.GetCredits() == 41);
+	CHECK(handler.GetGameTime() == 9);
+	CHECK(handler.IsDirty());
+	WriteFile("credits=42\n");
+	handler.LoadConfig();
+	CHECK(handler.GetCredits() == 42);
+	CHECK(handler.IsDirty());
+
+	handler.SaveConfig();
+	FileHandler reloaded;
+	reloaded.LoadConfig();
+	CHECK(reloaded.GetCredits() == 42);
+	CHECK(!reloaded.IsDirty());
+}
+
+TEST(TogglesRoundTrip)
+{
+	ScratchDirectory scratch;
+	CHECK(scratch.ready);
+	for (int toggles = 0; toggles < 8; toggles++)
+	{
+		FileHandler handler;
+		handler.LoadConfig();
+		handler.SetOptions((toggles & 1) != 0, (toggles & 2) != 0, (toggles & 4) != 0);
+		handler.SaveConfig();
+		CHECK(!handler.IsDirty());
+
+		FileHandler reloaded;
+		reloaded.LoadConfig();
+		CHECK(reloaded.GetConfig().useGravity == ((toggles & 1) != 0));
+		CHECK(reloaded.GetConfig().epilepticMode == ((toggles & 2) != 0));
+		CHECK(reloaded.GetConfig().useOwnShape == ((toggles & 4) != 0));
+		CHECK(!reloaded.IsDirty());
+	}
+}
@@ -0,0 +1,106 @@
+#include "Test.h"
+#include "FormatFixed.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace
+{
+	// whether FormatFixed() wrote exactly what printf writes
+	bool SameAsPrintf(double value, int decimals)
+	{
+		char expected[512];
+		snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+		wchar_t text[512];
+		const size_t length = FormatFixed(text, 512, L"", value, decimals);
+		if (length != strlen(expected))
+			return false;
+		for (size_t i = 0; i < length; i++)
+		{
+			if (text[i] != (wchar_t)expected[i])
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST(FormatFixedMatchesPrintfForEveryMicrosecond)
+{
+	// reaction times as the game has them, one second of microseconds at TimeDecimals
+	int mismatches = 0;
+	for (int us = 0; us < 1000000; us++)
+	{
+		if (!SameAsPrintf(us / 1e6, 3) || !SameAsPrintf(us * 1e-6, 3) || !SameAsPrintf(1.0 + us / 1e6, 5))
+			mismatches++;
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST(FormatFixedMatchesPrintfOnHalves)
+{
+	// 1.2345 is stored just below the half, 0.125 and 2.5 are exact ties that go to even
+	CHECK(SameAsPrintf(1.2345, 3));
+	CHECK(SameAsPrintf(0.125, 2));
+	CHECK(SameAsPrintf(0.375, 2));
+	CHECK(SameAsPrintf(0.5, 0));
+	CHECK(SameAsPrintf(1.5, 0));
+	CHECK(SameAsPrintf(2.5, 0));
+	CHECK(SameAsPrintf(4503599627370495.5, 0));
+	CHECK(SameAsPrintf(4503599627370496.5, 0));
+	CHECK(SameAsPrintf(9007199254740991.0, 0));
+	CHECK(SameAsPrintf(9007199254740993.0, 0));
+}
+
+TEST(FormatFixedMatchesPrintfOnEdgeValues)
+{
+	const double values[] = { 0.0, -0.0, -0.0004, -0.0005, 1e-300, -1e-300, 1e15, 123456789.987654321, 1e19, 1e300, -1e300,
+		std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max(),
+		std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+	for (double value : values)
+	{
+		for (int decimals = 0; decimals <= HUD_MAX_DECIMALS; decimals++)
+			CHECK(SameAsPrintf(value, decimals));
+	}
+}
+
+TEST(FormatFixedMatchesPrintfOnRandomValues)
+{
+	std::mt19937_64 random(22);
+	std::uniform_real_distribution<double> exponent(-12.0, 17.0);
+	int mismatches = 0;
+	for (int i = 0; i < 1000000; i++)
+	{
+		double value = std::pow(10.0, exponent(random));
+		if (random() & 1)
+			value = -value;
+		// halves of the last shown digit are where double rounding went wrong
+		const int decimals = (int)(random() % (HUD_MAX_DECIMALS + 1));
+		if (random() & 1)
+			value = (std::floor(value * 1e9) + 0.5) / std::pow(10.0, decimals);
+		if (!SameAsPrintf(value, decimals))
+			mismatches++;
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST(FormatFixedCutsAtTheBuffer)
+{
+	wchar_t text[8];
+	CHECK(FormatFixed(text, 8, L"t: ", 123.456, 3) == 7);
+	CHECK(wcscmp(text, L"t: 123.") == 0);
+	CHECK(FormatFixed(text, 0, L"t: ", 1.0, 0) == 0);
+}
+
+TEST(FormatFixedNeverAllocates)
+{
+	wchar_t text[64];
+	allocations = 0;
+	watchAllocations = true;
+	for (int i = 0; i < 100000; i++)
+		FormatFixed(text, 64, L"Reaction time: ", i * 1.234567e-5, i % (HUD_MAX_DECIMALS + 1));
+	FormatFixed(text, 64, L"", std::numeric_limits<double>::quiet_NaN(), 3);
+	FormatFixed(text, 64, L"", 1e300, 3);
+	watchAllocations = false;
+	CHECK(allocations == 0);
+}
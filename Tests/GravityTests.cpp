@@ -0,0 +1,114 @@
+#include "Test.h"
+#include "Gravity.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	struct Drop
+	{
+		Gravity gravity;
+		ShapePose pose;
+		bool triangle;
+		bool bounced = false;
+	};
+
+	Drop StartDrop(bool triangle)
+	{
+		Drop drop;
+		drop.triangle = triangle;
+		drop.pose.x = 500.0f;
+		drop.pose.y = 250.0f;
+		drop.pose.r = triangle ? 40.0f : 130.0f;
+		drop.gravity.Reset();
+		return drop;
+	}
+
+	const int ShapeSize = 200;
+	// long enough for both shapes to hit the floor and come back up
+	const int DropMilliseconds = 4000;
+
+	// the path at the tuned 1 kHz, one pose per millisecond
+	std::vector<ShapePose> ReferencePath(bool triangle)
+	{
+		Drop drop = StartDrop(triangle);
+		std::vector<ShapePose> path(1, drop.pose);
+		for (int ms = 0; ms < DropMilliseconds; ms++)
+		{
+			drop.gravity.Advance(0.001, drop.pose, drop.triangle, ShapeSize);
+			path.push_back(drop.pose);
+		}
+		return path;
+	}
+
+	// updates every intervals[i % count] microseconds, returns how far the pose ever got from the 1 kHz path
+	double WorstDeviation(bool triangle, const int* intervals, int count, bool* bounced)
+	{
+		const std::vector<ShapePose> reference = ReferencePath(triangle);
+		Drop drop = StartDrop(triangle);
+		double worst = 0.0;
+		*bounced = false;
+		int64_t now = 0;
+		for (int i = 0; now + intervals[i % count] <= DropMilliseconds * 1000; i++)
+		{
+			now += intervals[i % count];
+			drop.gravity.Advance(intervals[i % count] / 1e6, drop.pose, drop.triangle, ShapeSize);
+			*bounced = *bounced || drop.gravity.ascending;
+			// a step that isn't whole yet hasn't happened
+			const ShapePose& expected = reference[(size_t)(now / 1000)];
+			worst = std::max(worst, (double)std::fabs(drop.pose.x - expected.x));
+			worst = std::max(worst, (double)std::fabs(drop.pose.y - expected.y));
+			worst = std::max(worst, (double)std::fabs(drop.pose.r - expected.r));
+		}
+		return worst;
+	}
+
+	// any rate follows the 1 kHz path to within float noise, not just roughly
+	const double Bound = 1e-3;
+}
+
+TEST(GravityFollowsThe1kHzPathAt250Hz)
+{
+	const int interval[] = { 4000 };
+	bool bounced;
+	CHECK_NEAR(WorstDeviation(true, interval, 1, &bounced), 0.0, Bound);
+	CHECK(bounced);
+	CHECK_NEAR(WorstDeviation(false, interval, 1, &bounced), 0.0, Bound);
+	CHECK(bounced);
+}
+
+TEST(GravityFollowsThe1kHzPathAt60Hz)
+{
+	// 1/60 s doesn't divide into milliseconds, steps carry over between updates
+	const int interval[] = { 16667, 16666, 16667 };
+	bool bounced;
+	CHECK_NEAR(WorstDeviation(true, interval, 3, &bounced), 0.0, Bound);
+	CHECK(bounced);
+	CHECK_NEAR(WorstDeviation(false, interval, 3, &bounced), 0.0, Bound);
+	CHECK(bounced);
+}
+
+TEST(GravityFollowsThe1kHzPathWithJitter)
+{
+	// a 1 kHz loop that wakes early and late
+	const int intervals[] = { 700, 1300, 1000, 400, 1600, 950, 1050 };
+	const int count = sizeof(intervals) / sizeof(intervals[0]);
+	bool bounced;
+	CHECK_NEAR(WorstDeviation(true, intervals, count, &bounced), 0.0, Bound);
+	CHECK(bounced);
+	CHECK_NEAR(WorstDeviation(false, intervals, count, &bounced), 0.0, Bound);
+	CHECK(bounced);
+}
+
+TEST(GravityResetDropsCarriedTime)
+{
+	Drop drop = StartDrop(true);
+	drop.gravity.Advance(0.0009, drop.pose, true, ShapeSize);
+	CHECK(drop.pose.y == 250.0f);
+	drop.gravity.Reset();
+	drop.gravity.Advance(0.0009, drop.pose, true, ShapeSize);
+	CHECK(drop.pose.y == 250.0f);
+	drop.gravity.Advance(0.0001, drop.pose, true, ShapeSize);
+	CHECK(drop.pose.y > 250.0f);
+}
@@ -0,0 +1,83 @@
+#include "Test.h"
+#include "MessageAge.h"
+#include <cstdint>
+
+namespace
+{
+	// GetTickCount() as Windows keeps it: moved on by the timer interrupt every period
+	// microseconds, so it stays put between interrupts and then jumps by 15 or 16 ms
+	struct TickCounter
+	{
+		int64_t period;
+		int64_t phase;
+		uint32_t start;
+		uint32_t At(int64_t microseconds) const
+		{
+			const int64_t interrupts = (microseconds + phase) / period;
+			return start + static_cast<uint32_t>(interrupts * period / 1000);
+		}
+		uint32_t Granularity() const { return static_cast<uint32_t>((period + 999) / 1000); }
+	};
+
+	// Posts messages at odd times, handles them after delay microseconds on the exact clock,
+	// and back-dates them like MessageTime(). Returns the largest error, -1 when one was
+	// made out to be older than it was.
+	int64_t WorstBackdate(const TickCounter& ticks, int64_t delay)
+	{
+		int64_t worst = 0;
+		for (int64_t posted = 1000000; posted < 1000000 + 3 * ticks.period; posted += 997)
+		{
+			const int64_t handled = posted + delay;
+			const int64_t age = 1000 * static_cast<int64_t>(CertainMessageAge(ticks.At(handled), ticks.At(posted), ticks.Granularity()));
+			const int64_t error = handled - age - posted;
+			if (error < 0)
+				return -1;
+			if (error > worst)
+				worst = error;
+		}
+		return worst;
+	}
+}
+
+TEST(MessageAgeIsNeverTooOldAndOffByLessThanTwoTicks)
+{
+	// the default 64 Hz timer, timeBeginPeriod(1), and a 16 ms one
+	const TickCounter counters[] = { { 15625, 0, 0 }, { 15625, 7001, 0 }, { 1000, 321, 0 }, { 16000, 15999, 0 } };
+	for (const TickCounter& ticks : counters)
+	{
+		const int64_t bound = 2000 * ticks.Granularity();
+		for (int64_t delay = 0; delay <= (MAX_MESSAGE_AGE - ticks.Granularity()) * 1000; delay += 1237)
+		{
+			const int64_t worst = WorstBackdate(ticks, delay);
+			CHECK(worst >= 0);
+			CHECK(worst < bound);
+		}
+	}
+}
+
+TEST(MessageAgeIgnoresNoiseAndStaleMessages)
+{
+	// within a tick nothing is certain
+	CHECK(CertainMessageAge(1000, 1000, 16) == 0);
+	CHECK(CertainMessageAge(1016, 1000, 16) == 0);
+	CHECK(CertainMessageAge(1017, 1000, 16) == 1);
+	CHECK(CertainMessageAge(1100, 1000, 16) == 84);
+	// a message stamped after the read, and ones held up longer than any queue would
+	CHECK(CertainMessageAge(1000, 1001, 16) == 0);
+	CHECK(CertainMessageAge(1000 + MAX_MESSAGE_AGE, 1000, 16) == MAX_MESSAGE_AGE - 16);
+	CHECK(CertainMessageAge(1001 + MAX_MESSAGE_AGE, 1000, 16) == 0);
+}
+
+TEST(MessageAgeWrapsWithTheTickCount)
+{
+	// GetTickCount() wraps after 49.7 days
+	CHECK(CertainMessageAge(40, 0xFFFFFFF0u, 16) == 40);
+	// posted 100 ms before it wraps
+	const TickCounter ticks = { 15625, 0, 0u - 1100u };
+	for (int64_t delay = 0; delay <= 500000; delay += 1237)
+	{
+		const int64_t worst = WorstBackdate(ticks, delay);
+		CHECK(worst >= 0);
+		CHECK(worst < 2000 * ticks.Granularity());
+	}
+}
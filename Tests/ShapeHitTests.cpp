@@ -0,0 +1,112 @@
+#include "Test.h"
+#include "pch.h"
+#include "ShapeHitTest.h"
+#include <vector>
+
+using DirectX::SimpleMath::Vector2;
+
+// built once per path, see the Makefile
+#define SHAPE_HIT_PATH SHAPE_HIT_LANES == 8 ? "avx" : SHAPE_HIT_LANES == 4 ? "sse" : "scalar"
+
+namespace
+{
+	struct Triangle { Vector2 v[3]; };
+
+	// exact for the small whole numbers and halves used below
+	double Edge(Vector2 p, Vector2 a, Vector2 b)
+	{
+		return ((double)b.x - a.x) * ((double)p.y - a.y) - ((double)b.y - a.y) * ((double)p.x - a.x);
+	}
+
+	bool OnAnEdge(const std::vector<Triangle>& triangles, Vector2 p)
+	{
+		for (const Triangle& t : triangles)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				if (Edge(p, t.v[k], t.v[(k + 1) % 3]) == 0.0)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	struct Random
+	{
+		unsigned int seed;
+		int Next(int range) { seed = seed * 1103515245u + 12345u; return (seed >> 8) % range; }
+	};
+}
+
+TEST(ShapeHitTestAgreesWithIsCursorInsideTriangle)
+{
+	printf("  %s path, %d lanes\n", SHAPE_HIT_PATH, SHAPE_HIT_LANES);
+	Random random = { 42 };
+	int mismatches = 0;
+	int hits = 0;
+	// every count from a lone triangle to a few whole registers and a partial one, both windings
+	for (int count = 1; count <= 19; count++)
+	{
+		std::vector<Triangle> triangles;
+		ShapeHitTest hitTest;
+		while ((int)triangles.size() < count)
+		{
+			Triangle t;
+			for (int k = 0; k < 3; k++)
+				t.v[k] = Vector2((float)random.Next(64), (float)random.Next(64));
+			if (Edge(t.v[2], t.v[0], t.v[1]) == 0.0)
+				continue;
+			triangles.push_back(t);
+			hitTest.AddTriangle(t.v[0], t.v[1], t.v[2]);
+		}
+		CHECK(hitTest.TriangleCount() == (size_t)count);
+
+		for (int i = 0; i < 4000; i++)
+		{
+			const Vector2 p(random.Next(140) / 2.0f - 3.0f, random.Next(140) / 2.0f - 3.0f);
+			if (OnAnEdge(triangles, p))
+				continue;
+			bool expected = false;
+			for (const Triangle& t : triangles)
+				expected = expected || isCursorInsideTriangle(p, t.v[0], t.v[1], t.v[2]);
+			hits += expected;
+			mismatches += hitTest.Contains(p) != expected;
+		}
+	}
+	CHECK(mismatches == 0);
+	CHECK(hits > 1000);
+}
+
+TEST(ShapeHitTestPaddingLanesHitNothing)
+{
+	// a padding lane is 0 * x + 0 * y - 1, outside for every point, even infinite ones
+	const Vector2 points[] = { Vector2(0.0f, 0.0f), Vector2(-1e30f, 1e30f), Vector2(1e30f, -1e30f), Vector2(500.0f, 300.0f),
+		Vector2(INFINITY, INFINITY), Vector2(-INFINITY, 0.0f) };
+	ShapeHitTest hitTest;
+	for (int count = 1; count <= 9; count++)
+	{
+		hitTest.Clear();
+		// small and far from every point above, the other lanes of the register are padding
+		for (int i = 0; i < count; i++)
+			hitTest.AddTriangle(Vector2(10.0f + i, 10.0f), Vector2(11.0f + i, 10.0f), Vector2(10.0f + i, 11.0f));
+		for (const Vector2& p : points)
+			CHECK(!hitTest.Contains(p));
+		CHECK(hitTest.Contains(Vector2(10.25f + count - 1, 10.25f)));
+	}
+
+	// a bigger shape first, then a smaller one: the lanes it leaves behind are padding again
+	hitTest.Clear();
+	for (int i = 0; i < 9; i++)
+		hitTest.AddTriangle(Vector2(-1000.0f, -1000.0f), Vector2(1000.0f, -1000.0f), Vector2(0.0f, 1000.0f));
+	CHECK(hitTest.Contains(Vector2(0.0f, 0.0f)));
+	hitTest.Clear();
+	hitTest.AddTriangle(Vector2(10.0f, 10.0f), Vector2(11.0f, 10.0f), Vector2(10.0f, 11.0f));
+	CHECK(!hitTest.Contains(Vector2(0.0f, 0.0f)));
+	CHECK(hitTest.TriangleCount() == 1);
+
+	// flat triangles are left out instead of taking a lane
+	hitTest.Clear();
+	hitTest.AddTriangle(Vector2(0.0f, 0.0f), Vector2(5.0f, 5.0f), Vector2(10.0f, 10.0f));
+	CHECK(hitTest.TriangleCount() == 0);
+	CHECK(!hitTest.Contains(Vector2(5.0f, 5.0f)));
+}
@@ -0,0 +1,127 @@
+#include "Test.h"
+#include "pch.h"
+#include "ShapeTransform.h"
+#include "GameSize.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using DirectX::SimpleMath::Vector2;
+
+namespace
+{
+	// a lumpy outline around x, y, as wide and high as asked
+	std::vector<Vector2> Outline(float x, float y, float width, float height)
+	{
+		std::vector<Vector2> outline;
+		for (int i = 0; i < 64; i++)
+		{
+			const float angle = 6.2831853f * i / 64;
+			const float lump = i % 3 ? 1.0f : 0.8f;
+			outline.push_back(Vector2(x + 0.5f * width * lump * std::cos(angle), y + 0.5f * height * lump * std::sin(angle)));
+		}
+		return outline;
+	}
+
+	void Bounds(const std::vector<Vector2>& outline, Vector2& boxMin, Vector2& boxMax)
+	{
+		boxMin = boxMax = outline[0];
+		for (const Vector2& p : outline)
+		{
+			boxMin = Vector2::Min(boxMin, p);
+			boxMax = Vector2::Max(boxMax, p);
+		}
+	}
+
+	float RandomFloat()
+	{
+		return (float)rand() / (float)RAND_MAX;
+	}
+}
+
+TEST(PlacedShapesStayInTheWindow)
+{
+	srand(7);
+	const float fractions[] = { 0.1f, 0.5f, 0.9f, 0.99f, 1.0f };
+	for (float fraction : fractions)
+	{
+		// drawn anywhere in the editor, even partly off it
+		const std::vector<Vector2> outline = Outline(150.0f, 520.0f, fraction * GAME_WIDTH, fraction * GAME_HEIGHT);
+		Vector2 boxMin, boxMax;
+		Bounds(outline, boxMin, boxMax);
+		int outside = 0;
+		Vector2 lowest(1e9f, 1e9f), highest(-1e9f, -1e9f);
+		for (int i = 0; i < 2000; i++)
+		{
+			// the ends of the range too
+			const float u = i == 0 ? 0.0f : i == 1 ? 1.0f : RandomFloat();
+			const float v = i == 0 ? 0.0f : i == 1 ? 1.0f : RandomFloat();
+			const Vector2 offset = PlaceInWindow(boxMin, boxMax, u, v);
+			lowest = Vector2::Min(lowest, offset);
+			highest = Vector2::Max(highest, offset);
+			for (const Vector2& p : outline)
+			{
+				const Vector2 placed = p + offset;
+				outside += placed.x < -1e-3f || placed.x > GAME_WIDTH + 1e-3f || placed.y < -1e-3f || placed.y > GAME_HEIGHT + 1e-3f;
+			}
+		}
+		CHECK(outside == 0);
+		// every spot that fits can come up, from touching the left and top to touching the right and bottom
+		CHECK_NEAR(lowest.x + boxMin.x, 0.0, 1e-3);
+		CHECK_NEAR(lowest.y + boxMin.y, 0.0, 1e-3);
+		CHECK_NEAR(highest.x + boxMax.x, GAME_WIDTH, 1e-3);
+		CHECK_NEAR(highest.y + boxMax.y, GAME_HEIGHT, 1e-3);
+	}
+}
+
+TEST(ShapesBiggerThanTheWindowArePinned)
+{
+	// too wide and too high: the top left corner of the box goes to the top left of the window
+	Vector2 offset = PlaceInWindow(Vector2(-200.0f, 50.0f), Vector2(1100.0f, 800.0f), 0.3f, 0.7f);
+	CHECK(offset == Vector2(200.0f, -50.0f));
+	CHECK(PlaceInWindow(Vector2(-200.0f, 50.0f), Vector2(1100.0f, 800.0f), 1.0f, 0.0f) == offset);
+
+	// too wide only, it still moves up and down within the window
+	const Vector2 boxMin(10.0f, 100.0f), boxMax(10.0f + GAME_WIDTH + 1.0f, 300.0f);
+	for (float v : { 0.0f, 0.25f, 1.0f })
+	{
+		offset = PlaceInWindow(boxMin, boxMax, 0.5f, v);
+		CHECK(offset.x == -boxMin.x);
+		CHECK(offset.y + boxMin.y >= 0.0f);
+		CHECK(offset.y + boxMax.y <= GAME_HEIGHT);
+	}
+	CHECK_NEAR(PlaceInWindow(boxMin, boxMax, 0.5f, 0.25f).y, -100.0f + 0.25f * (GAME_HEIGHT - 200.0f), 1e-3);
+}
+
+TEST(ShapeWorldsReproduceTheOldCorners)
+{
+	srand(11);
+	for (int i = 0; i < 10000; i++)
+	{
+		const float x = i == 0 ? 0.0f : RandomFloat() * GAME_WIDTH;
+		const float y = i == 0 ? 0.0f : RandomFloat() * GAME_HEIGHT;
+		// r swings past size and below zero while the shape bounces
+		const float r = i == 0 ? 0.0f : (RandomFloat() - 0.3f) * 200.0f;
+		const float size = i == 0 ? 1.0f : 10.0f + RandomFloat() * 140.0f;
+
+		// what CreateTriangle() and CreateRectangle() used to write into the vertices
+		const Vector2 triangle[3] = { Vector2(x + r, y - size + r), Vector2(x, y + r), Vector2(x - size + r, y - r) };
+		const Vector2 rectangle[4] = { Vector2(x, y - size + r), Vector2(x - r, y), Vector2(x - size, y - r), Vector2(x - size + r, y - size) };
+
+		const float tolerance = 1e-4f * (1.0f + std::fabs(x) + std::fabs(y) + std::fabs(r) + size);
+		const DirectX::SimpleMath::Matrix triangleWorld = TriangleWorld(x, y, r, size);
+		for (int k = 0; k < 3; k++)
+		{
+			const Vector2 corner = Vector2::Transform(TriangleCorners[k], triangleWorld);
+			CHECK_NEAR(corner.x, triangle[k].x, tolerance);
+			CHECK_NEAR(corner.y, triangle[k].y, tolerance);
+		}
+		const DirectX::SimpleMath::Matrix rectangleWorld = RectangleWorld(x, y, r, size);
+		for (int k = 0; k < 4; k++)
+		{
+			const Vector2 corner = Vector2::Transform(RectangleCorners[k], rectangleWorld);
+			CHECK_NEAR(corner.x, rectangle[k].x, tolerance);
+			CHECK_NEAR(corner.y, rectangle[k].y, tolerance);
+		}
+	}
+}
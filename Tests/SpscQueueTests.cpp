@@ -0,0 +1,96 @@
+#include "Test.h"
+#include "SpscQueue.h"
+#include <cstdint>
+#include <thread>
+
+namespace
+{
+	// big enough that a torn copy would show, check is derived from sequence
+	struct Item
+	{
+		uint64_t sequence;
+		uint64_t check;
+		float x;
+		float y;
+	};
+
+	Item MakeItem(uint64_t sequence)
+	{
+		Item item = { sequence, sequence * 0x9E3779B97F4A7C15ull, (float)(sequence & 1023), (float)(sequence >> 10 & 1023) };
+		return item;
+	}
+
+	bool Intact(const Item& item)
+	{
+		const Item expected = MakeItem(item.sequence);
+		return item.check == expected.check && item.x == expected.x && item.y == expected.y;
+	}
+}
+
+TEST(SpscQueueHoldsCapacityMinusOne)
+{
+	SpscQueue<int, 8> queue;
+	int value;
+	CHECK(queue.Empty());
+	CHECK(!queue.Pop(value));
+	for (int i = 0; i < 7; i++)
+		CHECK(queue.Push(i));
+	CHECK(!queue.Push(7));
+	CHECK(!queue.Empty());
+	for (int i = 0; i < 7; i++)
+		CHECK(queue.Pop(value) && value == i);
+	CHECK(!queue.Pop(value));
+	CHECK(queue.Empty());
+}
+
+TEST(SpscQueueWrapsAround)
+{
+	SpscQueue<int, 4> queue;
+	int value;
+	bool inOrder = true;
+	for (int i = 0; i < 1000; i++)
+	{
+		inOrder = inOrder && queue.Push(2 * i) && queue.Push(2 * i + 1);
+		inOrder = inOrder && queue.Pop(value) && value == 2 * i;
+		inOrder = inOrder && queue.Pop(value) && value == 2 * i + 1;
+	}
+	CHECK(inOrder);
+	CHECK(queue.Empty());
+}
+
+TEST(SpscQueueStressKeepsOrderAcrossThreads)
+{
+	// small so both the full and the empty case get hit all the time
+	static SpscQueue<Item, 16> queue;
+	const uint64_t count = 2000000;
+
+	std::thread producer([count]()
+	{
+		for (uint64_t i = 0; i < count; i++)
+			while (!queue.Push(MakeItem(i)))
+				std::this_thread::yield();
+	});
+
+	uint64_t next = 0;
+	uint64_t outOfOrder = 0;
+	uint64_t torn = 0;
+	Item item;
+	while (next < count)
+	{
+		if (!queue.Pop(item))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (item.sequence != next)
+			outOfOrder++;
+		if (!Intact(item))
+			torn++;
+		next = item.sequence + 1;
+	}
+	producer.join();
+
+	CHECK(outOfOrder == 0);
+	CHECK(torn == 0);
+	CHECK(queue.Empty());
+}
@@ -0,0 +1,25 @@
+#include "Test.h"
+#include "Statistics.h"
+
+TEST(StateCpuTimeChargesTheStateBeingLeft)
+{
+	enum { menu, play, states };
+	StateCpuTime<states> cpu;
+	CHECK(cpu.Percent(menu) == 0.0);
+
+	// the first call only starts the clocks
+	cpu.Charge(menu, 10.0, 100.0);
+	CHECK(cpu.Percent(menu) == 0.0);
+	// two seconds of menu at 5% of a core, then play starts
+	cpu.Charge(menu, 10.1, 102.0);
+	CHECK_NEAR(cpu.Percent(menu), 5.0, 1e-9);
+	// a second of play on two busy threads, sampled halfway
+	cpu.Charge(play, 11.1, 102.5);
+	cpu.Charge(play, 12.1, 103.0);
+	CHECK_NEAR(cpu.Percent(play), 200.0, 1e-9);
+	CHECK_NEAR(cpu.Percent(menu), 5.0, 1e-9);
+	// back in the menu, an idle second brings its average down
+	cpu.Charge(menu, 12.1, 104.0);
+	CHECK_NEAR(cpu.Percent(menu), 10.0 / 3.0, 1e-9);
+	CHECK_NEAR(cpu.Percent(play), 200.0, 1e-9);
+}
@@ -0,0 +1,198 @@
+#include "Test.h"
+#include "StepTimer.h"
+
+// Clock the test moves by hand, copies of it share the same time
+struct FakeClock
+{
+	uint64_t* now;
+	uint64_t frequency;
+	uint64_t Frequency() const { return frequency; }
+	uint64_t Now() const { return *now; }
+};
+
+typedef DX::BasicStepTimer<FakeClock> FakeTimer;
+static const uint64_t TicksPerSecond = FakeTimer::TicksPerSecond;
+
+TEST(StepTimerFixedStepRunsOneUpdatePerTarget)
+{
+	uint64_t now = 0;
+	FakeTimer timer(FakeClock{ &now, TicksPerSecond });
+	timer.SetFixedTimeStep(true);
+	timer.SetTargetElapsedTicks(TicksPerSecond / 60);
+
+	int updates = 0;
+	for (int i = 0; i < 6000; i++)
+	{
+		now += TicksPerSecond / 60;
+		timer.Tick([&] { updates++; });
+	}
+	CHECK(updates == 6000);
+	CHECK(timer.GetFrameCount() == 6000);
+	CHECK(timer.GetElapsedTicks() == TicksPerSecond / 60);
+	CHECK(timer.GetTotalTicks() == 6000 * (TicksPerSecond / 60));
+}
+
+// A 60 Hz update on a 59.94 Hz display is off by 17 us a frame, well inside the snap,
+// so it never drops or doubles an update however long it runs
+TEST(StepTimerSnapsNearTargetDeltas)
+{
+	const uint64_t frequency = 1000000000;
+	uint64_t now = 0;
+	FakeTimer timer(FakeClock{ &now, frequency });
+	timer.SetFixedTimeStep(true);
+	timer.SetTargetElapsedSeconds(1.0 / 60.0);
+
+	bool steady = true;
+	for (int i = 0; i < 100000; i++)
+	{
+		now = (uint64_t)((i + 1) * (frequency * 1001.0 / 60000.0));
+		int updates = 0;
+		timer.Tick([&] { updates++; });
+		steady = steady && updates == 1;
+	}
+	CHECK(steady);
+	CHECK(timer.GetFrameCount() == 100000);
+}
+
+// At 60 Hz the snap is everything strictly inside 1/4000 s of the target
+TEST(StepTimerSnapBoundary)
+{
+	const uint64_t target = TicksPerSecond / 60;
+	const uint64_t snap = TicksPerSecond / 4000;
+
+	uint64_t now = 0;
+	FakeTimer inside(FakeClock{ &now, TicksPerSecond });
+	inside.SetFixedTimeStep(true);
+	inside.SetTargetElapsedTicks(target);
+	now = target - (snap - 1);
+	int updates = 0;
+	inside.Tick([&] { updates++; });
+	CHECK(updates == 1);
+	CHECK(inside.GetTotalTicks() == target);
+
+	now = 0;
+	FakeTimer outside(FakeClock{ &now, TicksPerSecond });
+	outside.SetFixedTimeStep(true);
+	outside.SetTargetElapsedTicks(target);
+	now = target - snap;
+	updates = 0;
+	outside.Tick([&] { updates++; });
+	CHECK(updates == 0);
+	CHECK_NEAR(outside.GetSecondsUntilNextUpdate(), FakeTimer::TicksToSeconds(snap), 1e-9);
+
+	now = 0;
+	FakeTimer above(FakeClock{ &now, TicksPerSecond });
+	above.SetFixedTimeStep(true);
+	above.SetTargetElapsedTicks(target);
+	now = target + snap;
+	updates = 0;
+	above.Tick([&] { updates++; });
+	CHECK(updates == 1);
+	CHECK_NEAR(above.GetSecondsUntilNextUpdate(), FakeTimer::TicksToSeconds(target - snap), 1e-9);
+}
+
+// Outside the snap the updates follow the clock: after an hour of 50 Hz ticks for a
+// 60 Hz target the simulation is exactly as far as the clock, minus what's left over
+TEST(StepTimerFixedStepDoesNotDrift)
+{
+	uint64_t now = 0;
+	FakeTimer timer(FakeClock{ &now, TicksPerSecond });
+	timer.SetFixedTimeStep(true);
+	timer.SetTargetElapsedTicks(TicksPerSecond / 60);
+
+	for (int i = 0; i < 50 * 3600; i++)
+	{
+		now += TicksPerSecond / 50;
+		timer.Tick([] {});
+	}
+	CHECK(timer.GetTotalTicks() <= now);
+	CHECK(now - timer.GetTotalTicks() < TicksPerSecond / 60);
+	CHECK(timer.GetFrameCount() == 60 * 3600);
+}
+
+// Clock units that don't divide into ticks must not lose the remainders either,
+// the ACPI timer's 3.579545 MHz, at the 1 kHz the game updates at while playing
+TEST(StepTimerOddFrequencyDoesNotDrift)
+{
+	const uint64_t frequency = 3579545;
+	uint64_t now = 0;
+	FakeTimer variable(FakeClock{ &now, frequency });
+	for (int i = 0; i < 1000 * 3600; i++)
+	{
+		now += frequency / 1000 + (i % 2);
+		variable.Tick([] {});
+	}
+	CHECK_NEAR(variable.GetTotalSeconds(), (double)now / frequency, 1e-6);
+}
+
+// The simulation thread wakes up a little late for almost every 1 ms play update.
+// Those wakeups are outside the snap, the updates keep up with the clock.
+TEST(StepTimerPlayRateFollowsLateWakeups)
+{
+	uint64_t now = 0;
+	FakeTimer timer(FakeClock{ &now, TicksPerSecond });
+	timer.SetFixedTimeStep(true);
+	timer.SetTargetElapsedSeconds(0.001);
+	for (int i = 0; i < 1000 * 60; i++)
+	{
+		now += TicksPerSecond / 1000 + TicksPerSecond / 10000;
+		timer.Tick([] {});
+	}
+	CHECK(now - timer.GetTotalTicks() < TicksPerSecond / 1000);
+
+	// a 60 Hz menu still gets the whole quarter millisecond
+	now = 0;
+	FakeTimer menu(FakeClock{ &now, TicksPerSecond });
+	menu.SetFixedTimeStep(true);
+	menu.SetTargetElapsedSeconds(1.0 / 60.0);
+	now = TicksPerSecond / 60 + TicksPerSecond / 4000 - 1;
+	int updates = 0;
+	menu.Tick([&] { updates++; });
+	CHECK(updates == 1);
+	CHECK(menu.GetTotalTicks() == TicksPerSecond / 60);
+}
+
+TEST(StepTimerClampsLongPauses)
+{
+	uint64_t now = 0;
+	FakeTimer timer(FakeClock{ &now, TicksPerSecond });
+	now = 5 * TicksPerSecond;
+	timer.Tick([] {});
+	CHECK(timer.GetElapsedTicks() == TicksPerSecond / 10);
+
+	timer.SetFixedTimeStep(true);
+	timer.SetTargetElapsedTicks(TicksPerSecond / 1000);
+	now += 5 * TicksPerSecond;
+	int updates = 0;
+	timer.Tick([&] { updates++; });
+	CHECK(updates == 100);
+}
+
+TEST(StepTimerResetElapsedTimeSkipsCatchUp)
+{
+	uint64_t now = 0;
+	FakeTimer timer(FakeClock{ &now, TicksPerSecond });
+	timer.SetFixedTimeStep(true);
+	timer.SetTargetElapsedTicks(TicksPerSecond / 60);
+	now += TicksPerSecond / 20;
+	timer.ResetElapsedTime();
+	int updates = 0;
+	timer.Tick([&] { updates++; });
+	CHECK(updates == 0);
+	CHECK_NEAR(timer.GetSecondsUntilNextUpdate(), 1.0 / 60.0, 1e-6);
+}
+
+TEST(StepTimerSteadyClockIsMonotonic)
+{
+	DX::SteadyClock clock;
+	uint64_t last = clock.Now();
+	bool monotonic = true;
+	for (int i = 0; i < 100000; i++)
+	{
+		uint64_t now = clock.Now();
+		monotonic = monotonic && now >= last;
+		last = now;
+	}
+	CHECK(monotonic);
+	CHECK(clock.Frequency() == 1000000000);
+}
@@ -0,0 +1,122 @@
+#include "Test.h"
+#include "StimulusClock.h"
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	typedef StimulusClock::TimePoint TimePoint;
+
+	TimePoint At(int milliseconds)
+	{
+		return TimePoint() + std::chrono::milliseconds(1000000 + milliseconds);
+	}
+}
+
+TEST(StimulusClockStartsAtTheFirstPresent)
+{
+	StimulusClock clock;
+	const unsigned int shown = clock.Generate(At(0));
+	CHECK(clock.Pending());
+	CHECK(clock.Elapsed(At(100)) == 0.0);
+
+	// not there until the simulation picks it up
+	clock.Presented(shown, At(24));
+	CHECK(clock.Pending());
+	clock.Process();
+	CHECK(!clock.Pending());
+	CHECK(clock.StartTime() == At(24));
+	CHECK_NEAR(clock.PresentDelay(), 0.024, 1e-9);
+	CHECK_NEAR(clock.Elapsed(At(274)), 0.25, 1e-9);
+	// an input stamped before the shape was on screen
+	CHECK(clock.Elapsed(At(20)) == 0.0);
+
+	// the same shape presented again doesn't move the start
+	clock.Presented(shown, At(40));
+	clock.Process();
+	CHECK(clock.StartTime() == At(24));
+}
+
+TEST(StimulusClockIgnoresStaleShapes)
+{
+	StimulusClock clock;
+	const unsigned int first = clock.Generate(At(0));
+	const unsigned int second = clock.Generate(At(5));
+	CHECK(second != first);
+
+	// the frame with the first shape only made it to the screen after the second was generated
+	clock.Presented(first, At(16));
+	clock.Process();
+	CHECK(clock.Pending());
+	CHECK(clock.Elapsed(At(100)) == 0.0);
+
+	clock.Presented(second, At(33));
+	clock.Presented(first, At(50));
+	clock.Process();
+	CHECK(!clock.Pending());
+	CHECK(clock.StartTime() == At(33));
+	CHECK_NEAR(clock.PresentDelay(), 0.028, 1e-9);
+
+	// a late present of the old one after the new one started counts for nothing either
+	const unsigned int third = clock.Generate(At(60));
+	clock.Presented(second, At(66));
+	clock.Process();
+	CHECK(clock.Pending());
+	CHECK_NEAR(clock.PresentDelay(), 0.028, 1e-9);
+	clock.Presented(third, At(83));
+	clock.Process();
+	CHECK(clock.StartTime() == At(83));
+	CHECK_NEAR(clock.PresentDelay(), 0.023, 1e-9);
+}
+
+TEST(StimulusClockRetriesWhenTheQueueIsFull)
+{
+	StimulusClock clock;
+	unsigned int shown = 0;
+	// a stalled simulation, every present brings a new shape it never got around to
+	for (int i = 0; i < 15; i++)
+		clock.Presented(shown = clock.Generate(At(i)), At(i));
+	const unsigned int last = clock.Generate(At(20));
+	clock.Presented(last, At(21));
+	clock.Process();
+	CHECK(clock.Pending());
+
+	// the next present of the same frame gets through
+	clock.Presented(last, At(37));
+	clock.Process();
+	CHECK(!clock.Pending());
+	CHECK(clock.StartTime() == At(37));
+	CHECK(shown != last);
+}
+
+TEST(StimulusClockAcrossThreads)
+{
+	StimulusClock clock;
+	std::atomic<unsigned int> onScreen{ 0 };
+	std::atomic<bool> running{ true };
+	// the render thread presents whatever frame it has
+	std::thread render([&]
+	{
+		while (running.load())
+		{
+			clock.Presented(onScreen.load(), std::chrono::high_resolution_clock::now());
+			std::this_thread::yield();
+		}
+	});
+
+	int late = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		const TimePoint generated = std::chrono::high_resolution_clock::now();
+		onScreen.store(clock.Generate(generated));
+		while (clock.Pending())
+		{
+			std::this_thread::yield();
+			clock.Process();
+		}
+		late += clock.StartTime() < generated || clock.PresentDelay() < 0.0;
+	}
+	running.store(false);
+	render.join();
+	CHECK(late == 0);
+}
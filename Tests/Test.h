@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Just enough of a test framework: TEST() registers a function that main() runs,
+// CHECK() reports a failed condition and keeps going.
+struct TestCase
+{
+	TestCase(const char* name, void (*run)());
+	const char* name;
+	void (*run)();
+	TestCase* next;
+};
+
+extern int testFailures;
+// operator new is counted while watchAllocations is set, for the code that runs every frame
+extern bool watchAllocations;
+extern int allocations;
+
+#define TEST(name) \
+	static void name(); \
+	static TestCase name##Case(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) { testFailures++; printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); } } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do { if (std::fabs((double)(a) - (double)(b)) > (tolerance)) { testFailures++; \
+		printf("  %s:%d: %s = %g, expected %g within %g\n", __FILE__, __LINE__, #a, (double)(a), (double)(b), (double)(tolerance)); } } while (0)
@@ -0,0 +1,54 @@
+#include "Test.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+int testFailures = 0;
+bool watchAllocations = false;
+int allocations = 0;
+
+void* operator new(size_t size)
+{
+	if (watchAllocations)
+		allocations++;
+	void* memory = std::malloc(size ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+static TestCase* firstTest = nullptr;
+static TestCase* lastTest = nullptr;
+
+TestCase::TestCase(const char* name, void (*run)()) : name(name), run(run), next(nullptr)
+{
+	// in registration order, that is file by file top to bottom
+	if (lastTest)
+		lastTest->next = this;
+	else
+		firstTest = this;
+	lastTest = this;
+}
+
+// runs every test, or only those whose name contains the first argument
+int main(int argc, char** argv)
+{
+	int run = 0;
+	for (TestCase* test = firstTest; test; test = test->next)
+	{
+		if (argc > 1 && !strstr(test->name, argv[1]))
+			continue;
+
+		const int failures = testFailures;
+		test->run();
+		printf("%s %s\n", testFailures == failures ? "ok  " : "FAIL", test->name);
+		run++;
+	}
+	printf("%d tests, %d failed checks\n", run, testFailures);
+	return testFailures == 0 ? 0 : 1;
+}
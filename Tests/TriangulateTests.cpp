@@ -0,0 +1,328 @@
+#include "Test.h"
+#include "pch.h"
+#include "Triangulate.h"
+#include <algorithm>
+#include <vector>
+
+using DirectX::SimpleMath::Vector2;
+
+namespace
+{
+	double SignedArea(Vector2 a, Vector2 b, Vector2 c)
+	{
+		return ((double)(b.x - a.x) * (c.y - a.y) - (double)(b.y - a.y) * (c.x - a.x)) / 2.0;
+	}
+
+	// shoelace
+	double SignedArea(const std::vector<Vector2>& outline)
+	{
+		double area = 0.0;
+		for (size_t i = 0; i < outline.size(); i++)
+			area += SignedArea(Vector2(0.0f, 0.0f), outline[i], outline[(i + 1) % outline.size()]);
+		return area;
+	}
+
+	// even-odd, only asked about points that aren't on the outline
+	bool InsideOutline(const std::vector<Vector2>& outline, Vector2 p)
+	{
+		bool inside = false;
+		for (size_t i = 0, j = outline.size() - 1; i < outline.size(); j = i++)
+		{
+			const Vector2 a = outline[i], b = outline[j];
+			if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+				inside = !inside;
+		}
+		return inside;
+	}
+
+	// edges included, the sampled points can fall on the cuts between two triangles
+	bool InsideTriangles(const std::vector<Vector2>& outline, const std::vector<uint16_t>& triangles, Vector2 p)
+	{
+		for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+		{
+			if (SignedArea(outline[triangles[i]], outline[triangles[i + 1]], outline[triangles[i + 2]]) == 0.0)
+				continue;
+			const double e0 = SignedArea(outline[triangles[i]], outline[triangles[i + 1]], p);
+			const double e1 = SignedArea(outline[triangles[i + 1]], outline[triangles[i + 2]], p);
+			const double e2 = SignedArea(outline[triangles[i + 2]], outline[triangles[i]], p);
+			if ((e0 >= 0.0 && e1 >= 0.0 && e2 >= 0.0) || (e0 <= 0.0 && e1 <= 0.0 && e2 <= 0.0))
+				return true;
+		}
+		return false;
+	}
+
+	std::vector<Vector2> Reversed(std::vector<Vector2> outline)
+	{
+		std::reverse(outline.begin(), outline.end());
+		return outline;
+	}
+
+	// n - 2 triangles, the returned area is theirs, and their signed areas add up to the outline's.
+	// A simple outline is covered exactly: every triangle turns its way and nothing overlaps.
+	void CheckTriangulation(const std::vector<Vector2>& outline, bool simple)
+	{
+		std::vector<uint16_t> triangles;
+		const float area = TriangulatePolygon(outline.data(), static_cast<int>(outline.size()), triangles);
+		CHECK(triangles.size() == 3 * (outline.size() - 2));
+
+		double signedSum = 0.0;
+		double sum = 0.0;
+		bool wound = true;
+		std::vector<bool> used(outline.size(), false);
+		for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+		{
+			const double a = SignedArea(outline[triangles[i]], outline[triangles[i + 1]], outline[triangles[i + 2]]);
+			signedSum += a;
+			sum += std::fabs(a);
+			wound = wound && a * SignedArea(outline) >= 0.0;
+			for (int k = 0; k < 3; k++)
+				used[triangles[i + k]] = true;
+		}
+		const double expected = SignedArea(outline);
+		CHECK_NEAR(signedSum, expected, 1e-3 * (1.0 + std::fabs(expected)));
+		CHECK_NEAR(area, sum, 1e-3 * (1.0 + sum));
+		CHECK(std::find(used.begin(), used.end(), false) == used.end());
+		if (simple)
+		{
+			CHECK_NEAR(sum, std::fabs(expected), 1e-3 * (1.0 + sum));
+			CHECK(wound);
+		}
+	}
+
+	std::vector<Vector2> Star(int points, float inner, float outer)
+	{
+		std::vector<Vector2> outline;
+		for (int i = 0; i < 2 * points; i++)
+		{
+			const float angle = 3.14159265f * i / points;
+			const float radius = i % 2 ? inner : outer;
+			outline.push_back(Vector2(500.0f + radius * std::cos(angle), 300.0f + radius * std::sin(angle)));
+		}
+		return outline;
+	}
+}
+
+TEST(TriangulateConvex)
+{
+	std::vector<Vector2> hexagon;
+	for (int i = 0; i < 6; i++)
+		hexagon.push_back(Vector2(100.0f * std::cos(i * 1.04719755f), 100.0f * std::sin(i * 1.04719755f)));
+	CheckTriangulation(hexagon, true);
+	CheckTriangulation(Reversed(hexagon), true);
+
+	const std::vector<Vector2> triangle = { Vector2(0.0f, 0.0f), Vector2(10.0f, 0.0f), Vector2(0.0f, 10.0f) };
+	CheckTriangulation(triangle, true);
+	CheckTriangulation(Reversed(triangle), true);
+}
+
+TEST(TriangulateConcave)
+{
+	// a fan around the first point covers the notch of the U
+	const std::vector<Vector2> u = { Vector2(0.0f, 0.0f), Vector2(30.0f, 0.0f), Vector2(30.0f, 100.0f), Vector2(70.0f, 100.0f),
+		Vector2(70.0f, 0.0f), Vector2(100.0f, 0.0f), Vector2(100.0f, 130.0f), Vector2(0.0f, 130.0f) };
+	for (const std::vector<Vector2>& outline : { u, Reversed(u) })
+	{
+		CheckTriangulation(outline, true);
+		std::vector<uint16_t> triangles;
+		TriangulatePolygon(outline.data(), static_cast<int>(outline.size()), triangles);
+		int wrong = 0;
+		for (float y = 0.5f; y < 130.0f; y += 1.0f)
+		{
+			for (float x = 0.5f; x < 100.0f; x += 1.0f)
+				wrong += InsideOutline(outline, Vector2(x, y)) != InsideTriangles(outline, triangles, Vector2(x, y));
+		}
+		CHECK(wrong == 0);
+	}
+
+	CheckTriangulation(Star(5, 40.0f, 100.0f), true);
+	CheckTriangulation(Reversed(Star(5, 40.0f, 100.0f)), true);
+	CheckTriangulation(Star(50, 90.0f, 100.0f), true);
+	CheckTriangulation(Reversed(Star(50, 90.0f, 100.0f)), true);
+}
+
+TEST(TriangulateCollinearAndDoubledPoints)
+{
+	// midpoints on every edge
+	const std::vector<Vector2> square = { Vector2(0.0f, 0.0f), Vector2(50.0f, 0.0f), Vector2(100.0f, 0.0f), Vector2(100.0f, 50.0f),
+		Vector2(100.0f, 100.0f), Vector2(50.0f, 100.0f), Vector2(0.0f, 100.0f), Vector2(0.0f, 50.0f) };
+	CheckTriangulation(square, true);
+	CheckTriangulation(Reversed(square), true);
+
+	// a freehand outline repeats points when the mouse stops
+	const std::vector<Vector2> doubled = { Vector2(0.0f, 0.0f), Vector2(0.0f, 0.0f), Vector2(100.0f, 0.0f), Vector2(100.0f, 100.0f),
+		Vector2(100.0f, 100.0f), Vector2(50.0f, 50.0f), Vector2(0.0f, 100.0f), Vector2(0.0f, 100.0f) };
+	CheckTriangulation(doubled, true);
+	CheckTriangulation(Reversed(doubled), true);
+
+	// a reflex corner right on the cut of the ear at 0, 0, touching it from outside, the ear is still valid
+	const std::vector<Vector2> touching = { Vector2(0.0f, 0.0f), Vector2(100.0f, 0.0f), Vector2(100.0f, 100.0f), Vector2(50.0f, 50.0f),
+		Vector2(50.0f, 100.0f), Vector2(0.0f, 100.0f) };
+	CheckTriangulation(touching, true);
+	CheckTriangulation(Reversed(touching), true);
+
+	// a notch coming down onto the bottom edge, cutting the ear at 100, 0 would cover it
+	const std::vector<Vector2> notch = { Vector2(0.0f, 0.0f), Vector2(100.0f, 0.0f), Vector2(100.0f, 100.0f), Vector2(60.0f, 100.0f),
+		Vector2(50.0f, 0.0f), Vector2(40.0f, 100.0f), Vector2(0.0f, 100.0f) };
+	CheckTriangulation(notch, true);
+	CheckTriangulation(Reversed(notch), true);
+
+	// no area at all
+	const std::vector<Vector2> line = { Vector2(0.0f, 0.0f), Vector2(50.0f, 50.0f), Vector2(100.0f, 100.0f), Vector2(20.0f, 20.0f) };
+	std::vector<uint16_t> triangles;
+	CHECK(TriangulatePolygon(line.data(), static_cast<int>(line.size()), triangles) == 0.0f);
+	CHECK(triangles.size() == 3 * 2);
+	CHECK(TriangulatePolygon(line.data(), 2, triangles) == 0.0f);
+	CHECK(triangles.empty());
+}
+
+TEST(TriangulateSelfIntersecting)
+{
+	// nothing is dropped, the signed areas still add up
+	const std::vector<Vector2> bowtie = { Vector2(0.0f, 0.0f), Vector2(100.0f, 100.0f), Vector2(100.0f, 0.0f), Vector2(0.0f, 100.0f) };
+	CheckTriangulation(bowtie, false);
+	CheckTriangulation(Reversed(bowtie), false);
+
+	std::vector<Vector2> pentagram;
+	for (int i = 0; i < 5; i++)
+		pentagram.push_back(Vector2(100.0f * std::cos(i * 2.51327412f), 100.0f * std::sin(i * 2.51327412f)));
+	CheckTriangulation(pentagram, false);
+	CheckTriangulation(Reversed(pentagram), false);
+
+	// a scribble crossing itself all over
+	std::vector<Vector2> scribble;
+	unsigned int seed = 12345;
+	for (int i = 0; i < 200; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const float x = (seed >> 8) % 1000;
+		seed = seed * 1103515245u + 12345u;
+		scribble.push_back(Vector2(x, (seed >> 8) % 600));
+	}
+	CheckTriangulation(scribble, false);
+}
+
+namespace
+{
+	double DistanceToSegment(Vector2 p, Vector2 a, Vector2 b)
+	{
+		const double dx = b.x - a.x, dy = b.y - a.y;
+		const double length = dx * dx + dy * dy;
+		double t = length > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length : 0.0;
+		t = std::min(1.0, std::max(0.0, t));
+		return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+	}
+
+	// how far the farthest point of the drawn outline is from the simplified one
+	double WorstDeviation(const std::vector<Vector2>& outline, const std::vector<Vector2>& simplified)
+	{
+		double worst = 0.0;
+		for (const Vector2& p : outline)
+		{
+			double nearest = 1e30;
+			for (size_t i = 0; i < simplified.size(); i++)
+				nearest = std::min(nearest, DistanceToSegment(p, simplified[i], simplified[(i + 1) % simplified.size()]));
+			worst = std::max(worst, nearest);
+		}
+		return worst;
+	}
+
+	// a wobbly freehand circle, points apart like mouse moves
+	std::vector<Vector2> Freehand(int count, float radius, float wobble)
+	{
+		std::vector<Vector2> outline;
+		for (int i = 0; i < count; i++)
+		{
+			const float angle = 6.2831853f * i / count;
+			const float r = radius + wobble * std::sin(angle * 37.0f) + 0.5f * wobble * std::sin(angle * 101.0f);
+			outline.push_back(Vector2(500.0f + r * std::cos(angle), 300.0f + r * std::sin(angle)));
+		}
+		return outline;
+	}
+}
+
+TEST(SimplifyStaysWithinTolerance)
+{
+	const std::vector<Vector2> outline = Freehand(2000, 200.0f, 6.0f);
+	for (float tolerance : { 0.5f, 1.5f, 4.0f, 20.0f })
+	{
+		std::vector<Vector2> simplified(outline);
+		SimplifyPolygon(simplified, tolerance);
+		CHECK(simplified.size() < outline.size());
+		CHECK(simplified[0] == outline[0]);
+		CHECK(WorstDeviation(outline, simplified) <= tolerance + 1e-3);
+	}
+}
+
+TEST(SimplifyLeavesSmallRingsAndZeroTolerance)
+{
+	const std::vector<Vector2> triangle = { Vector2(0.0f, 0.0f), Vector2(0.5f, 0.0f), Vector2(0.0f, 0.5f) };
+	std::vector<Vector2> points(triangle);
+	SimplifyPolygon(points, 100.0f);
+	CHECK(points == triangle);
+	points.resize(2);
+	SimplifyPolygon(points, 100.0f);
+	CHECK(points.size() == 2);
+
+	// collinear and doubled points stay too
+	const std::vector<Vector2> outline = { Vector2(0.0f, 0.0f), Vector2(0.0f, 0.0f), Vector2(50.0f, 0.0f), Vector2(100.0f, 0.0f),
+		Vector2(100.0f, 100.0f), Vector2(0.0f, 100.0f) };
+	points = outline;
+	SimplifyPolygon(points, 0.0f);
+	CHECK(points == outline);
+	points = Freehand(500, 100.0f, 3.0f);
+	SimplifyPolygon(points, 0.0f);
+	CHECK(points == Freehand(500, 100.0f, 3.0f));
+}
+
+TEST(ClosedOutlineIsCappedForTheCut)
+{
+	// a long scribble around the screen, far more detail than any tolerance keeps under the cap
+	std::vector<Vector2> points = Freehand(60000, 280.0f, 40.0f);
+	std::vector<uint16_t> triangles;
+	CHECK(SimplifyAndTriangulate(points, 1.5f, 256, triangles));
+	CHECK(points.size() <= 256);
+	CHECK(points.size() >= 3);
+	CHECK(triangles.size() == 3 * (points.size() - 2));
+
+	// the cap also ends when nothing is simplified away at first
+	points = Freehand(60000, 280.0f, 40.0f);
+	CHECK(SimplifyAndTriangulate(points, 0.0f, 256, triangles));
+	CHECK(points.size() <= 256);
+
+	// under the cap the outline is only simplified within tolerance
+	const std::vector<Vector2> outline = Freehand(200, 100.0f, 3.0f);
+	points = outline;
+	CHECK(SimplifyAndTriangulate(points, 1.5f, 256, triangles));
+	CHECK(WorstDeviation(outline, points) <= 1.5 + 1e-3);
+}
+
+TEST(ThinOutlineFallsBackToTheDrawnOne)
+{
+	// a sliver one pixel high, simplifying it leaves a line
+	std::vector<Vector2> outline;
+	for (int i = 0; i <= 100; i++)
+		outline.push_back(Vector2(100.0f + 2.0f * i, 100.0f));
+	for (int i = 100; i >= 0; i -= 10)
+		outline.push_back(Vector2(100.0f + 2.0f * i, 101.0f));
+	std::vector<Vector2> flattened(outline);
+	SimplifyPolygon(flattened, 1.5f);
+	std::vector<uint16_t> triangles;
+	CHECK(TriangulatePolygon(flattened.data(), static_cast<int>(flattened.size()), triangles) == 0.0f);
+
+	std::vector<Vector2> points(outline);
+	CHECK(SimplifyAndTriangulate(points, 1.5f, 256, triangles));
+	CHECK(points == outline);
+	CHECK(triangles.size() == 3 * (outline.size() - 2));
+
+	// too long to fall back to, the outline is given back untouched
+	points = outline;
+	CHECK(!SimplifyAndTriangulate(points, 1.5f, outline.size() - 1, triangles));
+	CHECK(points == outline);
+	CHECK(triangles.empty());
+
+	// a line has nothing to cut at all
+	const std::vector<Vector2> line = { Vector2(0.0f, 0.0f), Vector2(50.0f, 50.0f), Vector2(100.0f, 100.0f) };
+	points = line;
+	CHECK(!SimplifyAndTriangulate(points, 1.5f, 256, triangles));
+	CHECK(points == line);
+}
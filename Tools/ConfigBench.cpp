@@ -0,0 +1,90 @@
+// Times loading config.txt: FileHandler::LoadConfig() reading the key=value format in one
+// pass, against the version 1 reader that opened the file once per value and skipped
+// lines up to it. Works in a scratch directory under /tmp.
+
+#include "pch.h"
+#include "FileHandler.h"
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <unistd.h>
+
+#define BENCH_LOADS 20000
+
+typedef std::chrono::steady_clock Clock;
+
+// keeps the loads from being optimized away
+static volatile int sink;
+
+// the old GotoLine()
+static std::fstream& GotoLine(std::fstream& file, unsigned int num)
+{
+	file.seekg(std::ios::beg);
+	for (unsigned int i = 0; i < num - 1; ++i)
+		file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	return file;
+}
+
+// the old Read...FromFile(), without the clamping
+static int64_t ReadLine(unsigned int num)
+{
+	std::fstream myfile(CONFIG_FILE);
+	GotoLine(myfile, num);
+	int64_t value = 0;
+	myfile >> value;
+	return value;
+}
+
+static void Write(const char* text)
+{
+	FILE* file = fopen(CONFIG_FILE, "wb");
+	if (!file)
+		exit(1);
+	fputs(text, file);
+	fclose(file);
+}
+
+int main()
+{
+	char path[] = "/tmp/configbenchXXXXXX";
+	if (!mkdtemp(path) || chdir(path) != 0)
+		return 1;
+
+	Write("1234\n150\n20\n");
+	auto start = Clock::now();
+	for (int i = 0; i < BENCH_LOADS; i++)
+		sink = (int)(ReadLine(1) + ReadLine(2) + ReadLine(3));
+	const double positional = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / BENCH_LOADS;
+
+	// what the positional file reads as today, without the rewrite
+	FileHandler handler;
+	start = Clock::now();
+	for (int i = 0; i < BENCH_LOADS; i++)
+	{
+		handler.LoadConfig();
+		sink = handler.GetCredits();
+	}
+	const double legacy = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / BENCH_LOADS;
+
+	Write("version=2\ncredits=1234\nshapeSize=150\ngameTime=20\nuseGravity=1\nepilepticMode=0\nuseOwnShape=1\n");
+	start = Clock::now();
+	for (int i = 0; i < BENCH_LOADS; i++)
+	{
+		handler.LoadConfig();
+		sink = handler.GetCredits();
+	}
+	const double keyed = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / BENCH_LOADS;
+
+	printf("%d loads of config.txt, file opens per load in brackets\n", BENCH_LOADS);
+	printf("version 1 reader, 3 values          %8.0f ns  (3)\n", positional);
+	printf("LoadConfig(), version 1 file        %8.0f ns  (1)\n", legacy);
+	printf("LoadConfig(), version 2, 7 values   %8.0f ns  (1)\n", keyed);
+
+	remove(CONFIG_FILE);
+	rmdir(path);
+	return 0;
+}
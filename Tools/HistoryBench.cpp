@@ -0,0 +1,118 @@
+// Times History on generated logs: building the index, opening with it, and queries
+// shaped like the end menu's over a few years of samples
+
+#include "pch.h"
+#include "History.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#define BENCH_LOG_FILE "bench.bin"
+#define BENCH_INDEX_FILE "bench.idx"
+#define BENCH_YEARS 5
+
+typedef std::chrono::steady_clock Clock;
+
+static double Milliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// count samples spread evenly over the last BENCH_YEARS years, in random modes
+static bool WriteLog(size_t count, int64_t now)
+{
+	FILE* file = fopen(BENCH_LOG_FILE, "wb");
+	if (!file)
+		return false;
+
+	SessionLogHeader header = { SESSION_LOG_MAGIC, SESSION_LOG_VERSION };
+	fwrite(&header, sizeof(header), 1, file);
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> reaction(0.15f, 0.6f);
+	const int64_t span = (int64_t)BENCH_YEARS * 365 * 24 * 3600 * 1000000;
+	std::vector<SessionRecord> chunk(1 << 16);
+	for (size_t written = 0; written < count; )
+	{
+		size_t n = std::min(chunk.size(), count - written);
+		for (size_t i = 0; i < n; i++)
+		{
+			SessionRecord& record = chunk[i];
+			record.timestamp = now - span + (int64_t)((double)(written + i) / count * span);
+			record.reactionTime = reaction(random);
+			record.presentDelay = 0.008f;
+			record.x = 500.0f;
+			record.y = 300.0f;
+			record.size = 200;
+			record.shape = random() % 2;
+			// mostly hits, modes change between sessions of a hundred samples
+			record.flags = (random() % 20 ? session_hit : 0) | (((written + i) / 100 * 2654435761u >> 7) & 0x1e);
+		}
+		fwrite(chunk.data(), sizeof(SessionRecord), n, file);
+		written += n;
+	}
+	return fclose(file) == 0;
+}
+
+static void Query(const History& history, const char* name, const HistoryQuery& query)
+{
+	const int runs = 5;
+	HistoryStats stats;
+	auto start = Clock::now();
+	for (int i = 0; i < runs; i++)
+		stats = history.Aggregate(query);
+	printf("  %-34s %9zu samples %9.2f ms\n", name, stats.count, Milliseconds(start) / runs);
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<size_t> sizes;
+	for (int i = 1; i < argc; i++)
+		sizes.push_back((size_t)strtoull(argv[i], nullptr, 10));
+	if (sizes.empty())
+		sizes = { 1000000, 10000000, 100000000 };
+
+	const int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	const int64_t day = (int64_t)24 * 3600 * 1000000;
+	for (size_t size : sizes)
+	{
+		printf("%zu records\n", size);
+		auto start = Clock::now();
+		if (!WriteLog(size, now))
+		{
+			fprintf(stderr, "can't write " BENCH_LOG_FILE "\n");
+			return 1;
+		}
+		printf("  %-34s %28.2f ms\n", "write log", Milliseconds(start));
+
+		remove(BENCH_INDEX_FILE);
+		History history;
+		start = Clock::now();
+		if (!history.Open(BENCH_LOG_FILE, BENCH_INDEX_FILE))
+			return 1;
+		printf("  %-34s %28.2f ms\n", "open, building the index", Milliseconds(start));
+		start = Clock::now();
+		history.Open(BENCH_LOG_FILE, BENCH_INDEX_FILE);
+		printf("  %-34s %28.2f ms\n", "open with the index", Milliseconds(start));
+
+		HistoryQuery recent;
+		recent.from = now - 30 * day;
+		recent.flagMask = session_hit | session_crazy | session_gravity | session_ownShape;
+		recent.flagValue = session_hit | session_crazy | session_gravity;
+		Query(history, "30 days, crazy + gravity", recent);
+
+		HistoryQuery year = recent;
+		year.from = now - 365 * day;
+		Query(history, "1 year, crazy + gravity", year);
+
+		HistoryQuery all;
+		Query(history, "everything, all hits", all);
+
+		history.Close();
+		remove(BENCH_LOG_FILE);
+		remove(BENCH_INDEX_FILE);
+	}
+	return 0;
+}
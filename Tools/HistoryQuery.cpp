@@ -0,0 +1,96 @@
+// Command line front end to History, answers the same queries the game does
+// straight from a copy of sessions.bin
+
+#include "pch.h"
+#include "History.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void PrintUsage()
+{
+	printf("usage: historyquery [options]\n"
+		"  --log FILE        session log (default " SESSION_LOG_FILE ")\n"
+		"  --index FILE      block index, created when missing (default " HISTORY_INDEX_FILE ")\n"
+		"  --days N          only the last N days\n"
+		"  --crazy 0|1       only samples with crazy mode off or on, likewise\n"
+		"  --gravity 0|1     --epileptic 0|1 and --ownshape 0|1, any mode when left out\n"
+		"  --misses          misses instead of hits\n");
+}
+
+// restricts the query to samples where flag is on or off
+static void Require(HistoryQuery& query, uint8_t flag, const char* value)
+{
+	query.flagMask |= flag;
+	if (atoi(value))
+		query.flagValue |= flag;
+	else
+		query.flagValue &= ~flag;
+}
+
+int main(int argc, char** argv)
+{
+	const char* logFile = SESSION_LOG_FILE;
+	const char* indexFile = HISTORY_INDEX_FILE;
+	HistoryQuery query;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!strcmp(argv[i], "--misses"))
+		{
+			query.flagValue &= ~session_hit;
+			continue;
+		}
+		if (!value)
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		if (!strcmp(argv[i], "--log"))
+			logFile = value;
+		else if (!strcmp(argv[i], "--index"))
+			indexFile = value;
+		else if (!strcmp(argv[i], "--days"))
+			query.from = std::chrono::duration_cast<std::chrono::microseconds>((std::chrono::system_clock::now() - std::chrono::hours(24 * atoi(value))).time_since_epoch()).count();
+		else if (!strcmp(argv[i], "--crazy"))
+			Require(query, session_crazy, value);
+		else if (!strcmp(argv[i], "--gravity"))
+			Require(query, session_gravity, value);
+		else if (!strcmp(argv[i], "--epileptic"))
+			Require(query, session_epileptic, value);
+		else if (!strcmp(argv[i], "--ownshape"))
+			Require(query, session_ownShape, value);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+		i++;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	History history;
+	if (!history.Open(logFile, indexFile))
+	{
+		fprintf(stderr, "can't open %s\n", logFile);
+		return 1;
+	}
+	auto opened = std::chrono::steady_clock::now();
+	HistoryStats stats = history.Aggregate(query);
+	auto done = std::chrono::steady_clock::now();
+
+	printf("records in log  %zu\n", history.Count());
+	printf("matching        %zu\n", stats.count);
+	if (stats.count > 0)
+	{
+		printf("min             %.1f ms\n", stats.min * 1000.0);
+		printf("median          %.1f ms\n", stats.median * 1000.0);
+		printf("mean            %.1f ms\n", stats.mean * 1000.0);
+		printf("max             %.1f ms\n", stats.max * 1000.0);
+	}
+	printf("open %.2f ms, query %.2f ms\n", std::chrono::duration<double, std::milli>(opened - start).count(),
+		std::chrono::duration<double, std::milli>(done - opened).count());
+	return 0;
+}
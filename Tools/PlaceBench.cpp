@@ -0,0 +1,87 @@
+// Times PlaceInWindow() against the retry loop it replaced, which drew offsets from twice
+// the window size until every outline point landed inside, for custom shapes whose
+// bounding box takes 10% to 99% of the window.
+
+#include "pch.h"
+#include "ShapeTransform.h"
+#include "GameSize.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define BENCH_PLACEMENTS 20000
+// the retry loop gets this long per size, the biggest shapes need thousands of tries
+#define BENCH_RETRY_SECONDS 1.0
+#define BENCH_OUTLINE_POINTS 64
+
+using DirectX::SimpleMath::Vector2;
+typedef std::chrono::steady_clock Clock;
+
+// keeps the placements from being optimized away
+static volatile float sink;
+
+static float RandomFloat(float min, float max)
+{
+	return ((float)rand() / (float)RAND_MAX) * (max - min) + min;
+}
+
+// the old checkIfOwnShapeInWindow()
+static bool InWindow(const std::vector<Vector2>& outline, Vector2& offset)
+{
+	offset = Vector2(RandomFloat(-GAME_WIDTH, GAME_WIDTH), RandomFloat(-GAME_HEIGHT, GAME_HEIGHT));
+	for (const Vector2& p : outline)
+	{
+		if (p.x + offset.x > GAME_WIDTH || p.x + offset.x < 0.0f || p.y + offset.y > GAME_HEIGHT || p.y + offset.y < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+int main()
+{
+	printf("%d point outline, %dx%d window\n", BENCH_OUTLINE_POINTS, GAME_WIDTH, GAME_HEIGHT);
+	printf("box size  retries  retry loop  PlaceInWindow\n");
+	const float fractions[] = { 0.1f, 0.5f, 0.8f, 0.9f, 0.95f, 0.99f };
+	for (float fraction : fractions)
+	{
+		// an ellipse filling the box
+		std::vector<Vector2> outline;
+		Vector2 boxMin(1e9f, 1e9f), boxMax(-1e9f, -1e9f);
+		for (int i = 0; i < BENCH_OUTLINE_POINTS; i++)
+		{
+			const float angle = 6.2831853f * i / BENCH_OUTLINE_POINTS;
+			outline.push_back(Vector2(500.0f + 0.5f * fraction * GAME_WIDTH * std::cos(angle), 300.0f + 0.5f * fraction * GAME_HEIGHT * std::sin(angle)));
+			boxMin = Vector2::Min(boxMin, outline.back());
+			boxMax = Vector2::Max(boxMax, outline.back());
+		}
+
+		srand(1);
+		long long tries = 0;
+		int placed = 0;
+		Vector2 offset;
+		auto start = Clock::now();
+		while (placed < BENCH_PLACEMENTS && std::chrono::duration<double>(Clock::now() - start).count() < BENCH_RETRY_SECONDS)
+		{
+			tries++;
+			if (InWindow(outline, offset))
+			{
+				sink = offset.x;
+				placed++;
+			}
+		}
+		const double retry = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / placed;
+		const double retries = (double)tries / placed;
+
+		start = Clock::now();
+		for (int i = 0; i < BENCH_PLACEMENTS; i++)
+		{
+			const float u = RandomFloat(0.0f, 1.0f);
+			sink = PlaceInWindow(boxMin, boxMax, u, RandomFloat(0.0f, 1.0f)).x;
+		}
+		const double direct = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / BENCH_PLACEMENTS;
+		printf("%7.0f%%  %7.1f  %8.0f ns  %10.1f ns\n", 100.0f * fraction, retries, retry, direct);
+	}
+	return 0;
+}
@@ -0,0 +1,80 @@
+// Times ShapeHitTest::Contains() against testing the same triangles one at a time with
+// isCursorInsideTriangle(), for custom shapes of 3 to 1000 outline points.
+// shapehitbench runs the SSE2 path, shapehitbench-avx and shapehitbench-scalar the others.
+
+#include "pch.h"
+#include "ShapeHitTest.h"
+#include "Triangulate.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#define BENCH_POINTS 200000
+
+using DirectX::SimpleMath::Vector2;
+typedef std::chrono::steady_clock Clock;
+
+// a star around the middle of the window, every other point pulled in, like a spiky freehand outline
+static std::vector<Vector2> Star(int count)
+{
+	std::vector<Vector2> outline;
+	for (int i = 0; i < count; i++)
+	{
+		const float angle = 6.2831853f * i / count;
+		const float radius = i % 2 ? 150.0f : 250.0f;
+		outline.push_back(Vector2(500.0f + radius * std::cos(angle), 300.0f + radius * std::sin(angle)));
+	}
+	return outline;
+}
+
+int main()
+{
+	std::vector<Vector2> points;
+	unsigned int seed = 1;
+	for (int i = 0; i < BENCH_POINTS; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const float x = (seed >> 8) % 1000;
+		seed = seed * 1103515245u + 12345u;
+		points.push_back(Vector2(x, (float)((seed >> 8) % 600)));
+	}
+
+	printf("%s path, %d lanes, %d points per shape\n", SHAPE_HIT_LANES == 8 ? "avx" : SHAPE_HIT_LANES == 4 ? "sse" : "scalar",
+		SHAPE_HIT_LANES, BENCH_POINTS);
+	printf("vertices  triangles  one at a time  Contains  speedup  agree\n");
+	const int counts[] = { 3, 10, 30, 100, 300, 1000 };
+	for (int count : counts)
+	{
+		const std::vector<Vector2> outline = Star(count);
+		std::vector<uint16_t> triangles;
+		TriangulatePolygon(outline.data(), count, triangles);
+		ShapeHitTest hitTest;
+		for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+			hitTest.AddTriangle(outline[triangles[i]], outline[triangles[i + 1]], outline[triangles[i + 2]]);
+
+		std::vector<char> expected(points.size());
+		auto start = Clock::now();
+		for (size_t p = 0; p < points.size(); p++)
+		{
+			bool inside = false;
+			for (size_t i = 0; i + 2 < triangles.size() && !inside; i += 3)
+				inside = isCursorInsideTriangle(points[p], outline[triangles[i]], outline[triangles[i + 1]], outline[triangles[i + 2]]);
+			expected[p] = inside;
+		}
+		const double loop = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / points.size();
+
+		std::vector<char> got(points.size());
+		start = Clock::now();
+		for (size_t p = 0; p < points.size(); p++)
+			got[p] = hitTest.Contains(points[p]);
+		const double simd = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / points.size();
+
+		size_t agree = 0;
+		for (size_t p = 0; p < points.size(); p++)
+			agree += expected[p] == got[p];
+		printf("%8d  %9d  %10.1f ns  %5.1f ns  %6.1fx  %5.1f%%\n", count, (int)hitTest.TriangleCount(), loop, simd, loop / simd,
+			100.0 * agree / points.size());
+	}
+	return 0;
+}
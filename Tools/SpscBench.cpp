@@ -0,0 +1,99 @@
+// Times SpscQueue the way InputThread uses it: throughput of pointer events from one
+// thread to another, and the round trip of a single event through two queues
+
+#include "SpscQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#define BENCH_EVENTS 10000000
+#define BENCH_ROUND_TRIPS 100000
+// same as INPUT_QUEUE_SIZE
+#define BENCH_QUEUE_SIZE 1024
+
+typedef std::chrono::steady_clock Clock;
+
+// the size of InputThread's PointerEvent
+struct Event
+{
+	Clock::time_point time;
+	float x;
+	float y;
+};
+
+static SpscQueue<Event, BENCH_QUEUE_SIZE> forth;
+static SpscQueue<Event, BENCH_QUEUE_SIZE> back;
+
+static void Throughput()
+{
+	auto start = Clock::now();
+	std::thread producer([]()
+	{
+		Event event = { Clock::time_point(), 0.0f, 0.0f };
+		for (int i = 0; i < BENCH_EVENTS; i++)
+		{
+			event.x = (float)i;
+			while (!forth.Push(event))
+				std::this_thread::yield();
+		}
+	});
+
+	Event event;
+	for (int i = 0; i < BENCH_EVENTS; )
+	{
+		if (forth.Pop(event))
+			i++;
+		else
+			std::this_thread::yield();
+	}
+	producer.join();
+
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	printf("throughput  %.1f M events/s, %.1f ns per event\n", BENCH_EVENTS / seconds / 1e6, seconds * 1e9 / BENCH_EVENTS);
+}
+
+static void RoundTrip()
+{
+	std::thread echo([]()
+	{
+		Event event;
+		for (int i = 0; i < BENCH_ROUND_TRIPS; )
+		{
+			if (forth.Pop(event))
+			{
+				while (!back.Push(event))
+					std::this_thread::yield();
+				i++;
+			}
+			else
+				std::this_thread::yield();
+		}
+	});
+
+	std::vector<double> trips;
+	trips.reserve(BENCH_ROUND_TRIPS);
+	Event event = { Clock::time_point(), 0.0f, 0.0f };
+	for (int i = 0; i < BENCH_ROUND_TRIPS; i++)
+	{
+		event.time = Clock::now();
+		forth.Push(event);
+		while (!back.Pop(event))
+			std::this_thread::yield();
+		trips.push_back(std::chrono::duration<double, std::micro>(Clock::now() - event.time).count());
+	}
+	echo.join();
+
+	std::sort(trips.begin(), trips.end());
+	printf("round trip  median %.2f us, p99 %.2f us, max %.2f us\n",
+		trips[trips.size() / 2], trips[trips.size() * 99 / 100], trips.back());
+}
+
+int main()
+{
+	printf("%u hardware threads, yielding when full or empty\n", std::thread::hardware_concurrency());
+	Throughput();
+	RoundTrip();
+	return 0;
+}